@@ -29,6 +29,17 @@
  * $M = new Maurina();
  * $M->log('This is a user defined message');
  *
+ * Timings are sent as spans and shown in the console profiler. Pass the id
+ * of the enclosing span to nest them:
+ *
+ * $request = $M->spanStart('GET /users');
+ * $query = $M->spanStart('SELECT users', $request);
+ * $M->spanEnd($query);
+ * $M->spanEnd($request);
+ *
+ * Finished spans are held and sent together once no span is left open (or
+ * at shutdown), so sending them never adds time to the spans measured.
+ *
  *
  * Additional startup configurations:
  *
@@ -40,6 +51,8 @@
  *
  * -- Changelog --
  *
+ * 1.8 Added timing spans for the console profiler
+ * 1.7 Errors are sent with their level so the console can prioritize them
  * 1.6 PHP7 compatibility and other enhancements
  * 1.5 Fixed Github issue #5
  * 1.4 Changed tags for console version 1.2
@@ -50,7 +63,7 @@
  */
 class Maurina
 {
-	public $version='1.6';
+	public $version='1.8';
 
 	/* CONFIGURE HERE THE ERROR REPORTING LEVEL */
 
@@ -79,6 +92,7 @@ class Maurina
 	const TYPE_COOKIES = 5;
 
 	const MAX_MSG_SIZE = 5000;
+	const MAX_SPANS_PER_PACKET = 50;
 
 	private $serverIp    = '127.0.0.1';
 	private $serverPort  = 1947;
@@ -88,6 +102,9 @@ class Maurina
 	private $numPacketsSent = 0;
 	private $numPacketsBeforePause = 50;
 
+	private $openSpans = array();
+	private $endedSpans = array();
+
 	public $cdata=[]; // Place to allow persistent data to be stored by external processes
 
 	public $doHtmlEntities = true;
@@ -143,54 +160,91 @@ class Maurina
 			$this->sendLog(Maurina::TYPE_USER, $packet, false);
 	}
 
+	public function spanStart($name, $parent = null)
+	{
+		$id = uniqid('', true);
+		$this->openSpans[$id] = array('name'  => $name,
+		                              'id'    => $id,
+		                              'start' => microtime(true) * 1000);
+		if ($parent !== null)
+			$this->openSpans[$id]['parent'] = $parent;
+
+		return $id;
+	}
+
+	public function spanEnd($id)
+	{
+		if (!isset($this->openSpans[$id]))
+			return;
+
+		$span = $this->openSpans[$id];
+		unset($this->openSpans[$id]);
+
+		$span['duration'] = microtime(true) * 1000 - $span['start'];
+		$this->endedSpans[] = $span;
+
+		if (count($this->openSpans) == 0)
+			$this->sendSpans();
+	}
+
+	private function sendSpans()
+	{
+		foreach (array_chunk($this->endedSpans, Maurina::MAX_SPANS_PER_PACKET)
+		         as $spans)
+			$this->sendData(array('span' => $spans));
+
+		$this->endedSpans = array();
+	}
+
 	public function errorHandler($errorNumber, $errorMsg, $errorFile, $errorLine)
 	{
 		$type = '';
+		$level = 'warning';
 		switch ($errorNumber)
 		{
-			case 1     : $type = 'E_ERROR';
+			case 1     : $type = 'E_ERROR'; $level = 'error';
 						 if (!$this->_ERROR) return;
 						 break;
 			case 2     : $type = 'E_WARNING';
 						 if (!$this->_WARNING) return;
 						 break;
-			case 4     : $type = 'E_PARSE';
+			case 4     : $type = 'E_PARSE'; $level = 'error';
 						 if (!$this->_PARSE) return;
 						 break;
-			case 8     : $type = 'E_NOTICE';
+			case 8     : $type = 'E_NOTICE'; $level = 'notice';
 						 if (!$this->_NOTICE) return;
 						 break;
-			case 16    : $type = 'E_CORE_ERROR';
+			case 16    : $type = 'E_CORE_ERROR'; $level = 'error';
 						 if (!$this->_CORE_ERROR) return;
 						 break;
 			case 32    : $type = 'E_CORE_WARNING';
 						 if (!$this->_CORE_WARNING) return;
 						 break;
-			case 64    : $type = 'E_COMPILE_ERROR';
+			case 64    : $type = 'E_COMPILE_ERROR'; $level = 'error';
 						 if (!$this->_COMPILE_ERROR) return;
 						 break;
 			case 128   : $type = 'E_COMPILE_WARNING';
 						 if (!$this->_COMPILE_WARNING) return;
 						 break;
-			case 256   : $type = 'E_USER_ERROR';
+			case 256   : $type = 'E_USER_ERROR'; $level = 'error';
 						 if (!$this->_USER_ERROR) return;
 						 break;
 			case 512   : $type = 'E_USER_WARNING';
 						 if (!$this->_USER_WARNING) return;
 						 break;
-			case 1024  : $type = 'E_USER_NOTICE';
+			case 1024  : $type = 'E_USER_NOTICE'; $level = 'notice';
 						 if (!$this->_USER_NOTICE) return;
 						 break;
-			case 2048  : $type = 'E_STRICT';
+			case 2048  : $type = 'E_STRICT'; $level = 'notice';
 						 if (!$this->_STRICT) return;
 						 break;
-			case 4096  : $type = 'E_RECOVERABLE_ERROR';
+			case 4096  : $type = 'E_RECOVERABLE_ERROR'; $level = 'error';
 						 if (!$this->_RECOVERABLE_ERROR) return;
 						 break;
-			case 8192  : $type = 'E_DEPRECATED';
+			case 8192  : $type = 'E_DEPRECATED'; $level = 'notice';
 						 if (!$this->_DEPRECATED) return;
 						 break;
-			case 16384 : $type = 'E_USER_DEPRECATED';
+			case 16384 : $type = 'E_USER_DEPRECATED'; $level = 'notice';
 						 if (!$this->_USER_DEPRECATED) return;
 						 break;
 			case 32767 : $type = 'E_ALL'; break;
@@ -233,7 +287,7 @@ class Maurina
 				break;
 		}
 
-		$this->sendLog(Maurina::TYPE_ERRORS, $message);
+		$this->sendLog(Maurina::TYPE_ERRORS, $message, false, $level);
 	}
 
 	public function shutdown()
@@ -243,11 +297,14 @@ class Maurina
 			$this->errorHandler($error['type'], $error['message'],
 			                    $error['file'], $error['line']);
 		}
+
+		// Spans never ended are not sent, those that did are
+		if (count($this->endedSpans) > 0)
+			$this->sendSpans();
 	}
 
-	private function sendLog($type, $message, $showTime = false)
+	private function sendLog($type, $message, $showTime = false, $level = '')
 	{
-		$socket = socket_create(AF_INET, SOCK_DGRAM, SOL_UDP);
 		$data = array('tabs' => $this->tabCaptions,
 		              'log1' => '',
 		              'log2' => '',
@@ -255,6 +312,9 @@ class Maurina
 		              'log4' => '',
 		              'log5' => '');
 
+		if ($level != '')
+			$data['level'] = $level;
+
 		if ($showTime)
 		{
 			$time    = "<time>[".date('H:i:s') . ']</time> ';
@@ -270,6 +330,12 @@ class Maurina
 			case Maurina::TYPE_COOKIES : $data['log5'] = $message; break;
 		}
 
+		$this->sendData($data);
+	}
+
+	private function sendData($data)
+	{
+		$socket = socket_create(AF_INET, SOCK_DGRAM, SOL_UDP);
 		$data = json_encode($data);
 
 		// Insert pause to prevent overflows
@@ -0,0 +1,609 @@
+#include "DatagramDecoder.h"
+
+#include <cstring>
+
+// Nesting allowed for skipped values
+#define MAX_DEPTH 64
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+
+    return -1;
+}
+
+bool JsonSlice::equals(const char *text) const
+{
+    int length = (int) strlen(text);
+
+    return !this->escaped && this->size == length &&
+           memcmp(this->data, text, length) == 0;
+}
+
+bool JsonSlice::equals(const QByteArray &bytes) const
+{
+    return this->size == bytes.size() &&
+           memcmp(this->data, bytes.constData(), this->size) == 0;
+}
+
+QString JsonSlice::toString() const
+{
+    if (!this->escaped)
+    {
+        if (this->ascii)
+            return QString::fromLatin1(this->data, this->size);
+        return QString::fromUtf8(this->data, this->size);
+    }
+
+    // Escaped strings are copied in runs between escape sequences. Escapes
+    // are plain ASCII so they never split a multibyte UTF-8 sequence.
+    QString result;
+    result.reserve(this->size);
+
+    const char *c = this->data;
+    const char *last = this->data + this->size;
+    while (c < last)
+    {
+        const char *run = c;
+        bool ascii = true;
+        while (c < last && *c != '\\')
+        {
+            ascii = ascii && !(*c & 0x80);
+            ++c;
+        }
+
+        if (c > run)
+        {
+            if (ascii)
+                result.append(QLatin1String(run, (int) (c - run)));
+            else result.append(QString::fromUtf8(run, (int) (c - run)));
+        }
+
+        if (c >= last)
+            break;
+
+        // Escape sequences were validated while decoding
+        switch (c[1])
+        {
+            case 'b': result.append(QLatin1Char('\b')); break;
+            case 'f': result.append(QLatin1Char('\f')); break;
+            case 'n': result.append(QLatin1Char('\n')); break;
+            case 'r': result.append(QLatin1Char('\r')); break;
+            case 't': result.append(QLatin1Char('\t')); break;
+            case 'u':
+            {
+                ushort code = (ushort) ((hexValue(c[2]) << 12) |
+                                        (hexValue(c[3]) << 8) |
+                                        (hexValue(c[4]) << 4) |
+                                        hexValue(c[5]));
+                result.append(QChar(code));
+                c += 4;
+                break;
+            }
+            default: result.append(QLatin1Char(c[1])); break;
+        }
+        c += 2;
+    }
+
+    return result;
+}
+
+DatagramDecoder::DatagramDecoder() :
+    pos(NULL), end(NULL), depth(0), tabsFound(false), tabsCount(0),
+    levelValue(0), spansCount(0)
+{
+}
+
+void DatagramDecoder::reset()
+{
+    this->tabsFound = false;
+    this->tabsCount = 0;
+    this->tabsRaw = JsonSlice();
+    for (int x = 0; x < DATAGRAM_LOGS; ++x)
+    {
+        this->tabs[x] = JsonSlice();
+        this->logs[x] = JsonSlice();
+    }
+    this->levelValue = 0;
+    this->spansCount = 0;
+    this->depth = 0;
+}
+
+bool DatagramDecoder::decode(const QByteArray &datagram)
+{
+    this->reset();
+    this->pos = datagram.constData();
+    this->end = this->pos + datagram.size();
+
+    this->skipWhitespace();
+    if (this->pos >= this->end || *this->pos != '{')
+        return false;
+    ++this->pos;
+
+    this->skipWhitespace();
+    if (this->pos < this->end && *this->pos == '}')
+        ++this->pos;
+    else while (true)
+    {
+        JsonSlice key;
+        if (!this->parseString(&key))
+            return false;
+
+        this->skipWhitespace();
+        if (this->pos >= this->end || *this->pos != ':')
+            return false;
+        ++this->pos;
+        this->skipWhitespace();
+
+        // Route known fields, skip the rest
+        bool isString = (this->pos < this->end && *this->pos == '"');
+        int logIndex = -1;
+        if (key.size == 4 && !key.escaped &&
+            memcmp(key.data, "log", 3) == 0 &&
+            key.data[3] >= '1' && key.data[3] <= '0' + DATAGRAM_LOGS)
+            logIndex = key.data[3] - '1';
+
+        if (logIndex >= 0 && isString)
+        {
+            if (!this->parseString(&this->logs[logIndex]))
+                return false;
+        }
+        else if (key.equals("tabs") && this->pos < this->end &&
+                 *this->pos == '[')
+        {
+            if (!this->parseTabs())
+                return false;
+        }
+        else if (key.equals("level"))
+        {
+            if (!this->parseLevel())
+                return false;
+        }
+        else if (key.equals("span"))
+        {
+            if (!this->parseSpans())
+                return false;
+        }
+        else if (!this->skipValue())
+            return false;
+
+        this->skipWhitespace();
+        if (this->pos >= this->end)
+            return false;
+        if (*this->pos == '}')
+        {
+            ++this->pos;
+            break;
+        }
+        if (*this->pos != ',')
+            return false;
+        ++this->pos;
+        this->skipWhitespace();
+    }
+
+    // Nothing but whitespace may follow the object
+    this->skipWhitespace();
+    return this->pos == this->end;
+}
+
+void DatagramDecoder::skipWhitespace()
+{
+    while (this->pos < this->end &&
+           (*this->pos == ' ' || *this->pos == '\n' ||
+            *this->pos == '\r' || *this->pos == '\t'))
+        ++this->pos;
+}
+
+bool DatagramDecoder::parseString(JsonSlice *slice)
+{
+    if (this->pos >= this->end || *this->pos != '"')
+        return false;
+    ++this->pos;
+
+    slice->data = this->pos;
+    slice->escaped = false;
+    slice->ascii = true;
+
+    while (this->pos < this->end)
+    {
+        unsigned char c = (unsigned char) *this->pos;
+        if (c == '"')
+        {
+            slice->size = (int) (this->pos - slice->data);
+            ++this->pos;
+            return true;
+        }
+
+        // Control characters must be escaped
+        if (c < 0x20)
+            return false;
+
+        if (c & 0x80)
+            slice->ascii = false;
+
+        if (c == '\\')
+        {
+            slice->escaped = true;
+            if (this->end - this->pos < 2)
+                return false;
+
+            switch (this->pos[1])
+            {
+                case '"': case '\\': case '/': case 'b':
+                case 'f': case 'n':  case 'r': case 't':
+                    this->pos += 2;
+                    break;
+                case 'u':
+                    if (this->end - this->pos < 6 ||
+                        hexValue(this->pos[2]) < 0 ||
+                        hexValue(this->pos[3]) < 0 ||
+                        hexValue(this->pos[4]) < 0 ||
+                        hexValue(this->pos[5]) < 0)
+                        return false;
+                    this->pos += 6;
+                    break;
+                default:
+                    return false;
+            }
+            continue;
+        }
+
+        ++this->pos;
+    }
+
+    // Unterminated string
+    return false;
+}
+
+bool DatagramDecoder::parseTabs()
+{
+    const char *start = this->pos;
+    ++this->pos;
+    this->skipWhitespace();
+
+    if (this->pos < this->end && *this->pos == ']')
+        ++this->pos;
+    else while (true)
+    {
+        // Only as many captions as logs are kept
+        if (this->pos < this->end && *this->pos == '"' &&
+            this->tabsCount < DATAGRAM_LOGS)
+        {
+            if (!this->parseString(&this->tabs[this->tabsCount]))
+                return false;
+        }
+        else if (!this->skipValue())
+            return false;
+
+        if (this->tabsCount < DATAGRAM_LOGS)
+            ++this->tabsCount;
+
+        this->skipWhitespace();
+        if (this->pos >= this->end)
+            return false;
+        if (*this->pos == ']')
+        {
+            ++this->pos;
+            break;
+        }
+        if (*this->pos != ',')
+            return false;
+        ++this->pos;
+        this->skipWhitespace();
+    }
+
+    this->tabsFound = true;
+    this->tabsRaw.data = start;
+    this->tabsRaw.size = (int) (this->pos - start);
+    return true;
+}
+
+bool DatagramDecoder::parseLevel()
+{
+    // Levels 1 to 6 match the <h1> to <h6> tags. Names are accepted too.
+    static const char *names[] = { "error", "warning", "notice", "info",
+                                   "debug" };
+
+    if (this->pos < this->end && *this->pos == '"')
+    {
+        JsonSlice name;
+        if (!this->parseString(&name))
+            return false;
+
+        if (name.equals("fatal") || name.equals("critical"))
+            this->levelValue = 1;
+        for (int x = 0; x < 5; ++x)
+        {
+            if (name.equals(names[x]))
+                this->levelValue = x + 1;
+        }
+        return true;
+    }
+
+    const char *start = this->pos;
+    if (!this->skipNumber())
+        return false;
+
+    if (this->pos - start == 1 && *start >= '1' && *start <= '6')
+        this->levelValue = *start - '0';
+    return true;
+}
+
+bool DatagramDecoder::parseSpans()
+{
+    // A single span object or an array of them
+    if (this->pos >= this->end || *this->pos != '[')
+        return this->parseSpan();
+
+    ++this->pos;
+    this->skipWhitespace();
+    if (this->pos < this->end && *this->pos == ']')
+    {
+        ++this->pos;
+        return true;
+    }
+
+    while (true)
+    {
+        if (!this->parseSpan())
+            return false;
+
+        this->skipWhitespace();
+        if (this->pos >= this->end)
+            return false;
+        if (*this->pos == ']')
+        {
+            ++this->pos;
+            return true;
+        }
+        if (*this->pos != ',')
+            return false;
+        ++this->pos;
+        this->skipWhitespace();
+    }
+}
+
+bool DatagramDecoder::parseSpan()
+{
+    if (this->pos >= this->end || *this->pos != '{')
+        return this->skipValue();
+
+    // Records are reused between datagrams
+    if (this->spansCount == this->spans.size())
+        this->spans.resize(this->spansCount + 1);
+
+    DatagramSpan &span = this->spans[this->spansCount];
+    span.name = JsonSlice();
+    span.id = JsonSlice();
+    span.parent = JsonSlice();
+    span.start = 0;
+    span.duration = -1;
+
+    ++this->pos;
+    this->skipWhitespace();
+    if (this->pos < this->end && *this->pos == '}')
+    {
+        ++this->pos;
+        return true;
+    }
+
+    while (true)
+    {
+        JsonSlice key;
+        if (!this->parseString(&key))
+            return false;
+
+        this->skipWhitespace();
+        if (this->pos >= this->end || *this->pos != ':')
+            return false;
+        ++this->pos;
+        this->skipWhitespace();
+
+        bool ok;
+        if (key.equals("name") && this->pos < this->end && *this->pos == '"')
+            ok = this->parseString(&span.name);
+        else if (key.equals("id"))
+            ok = this->parseId(&span.id);
+        else if (key.equals("parent"))
+            ok = this->parseId(&span.parent);
+        else if (key.equals("start"))
+            ok = this->parseNumber(&span.start);
+        else if (key.equals("duration"))
+            ok = this->parseNumber(&span.duration);
+        else ok = this->skipValue();
+
+        if (!ok)
+            return false;
+
+        this->skipWhitespace();
+        if (this->pos >= this->end)
+            return false;
+        if (*this->pos == '}')
+        {
+            ++this->pos;
+            break;
+        }
+        if (*this->pos != ',')
+            return false;
+        ++this->pos;
+        this->skipWhitespace();
+    }
+
+    // Spans without a name or a duration are ignored
+    if (!span.name.isEmpty() && span.duration >= 0)
+        ++this->spansCount;
+
+    return true;
+}
+
+bool DatagramDecoder::parseId(JsonSlice *slice)
+{
+    if (this->pos < this->end && *this->pos == '"')
+        return this->parseString(slice);
+
+    // Numeric ids are kept as sent, null leaves the id empty
+    const char *start = this->pos;
+    if (!this->skipValue())
+        return false;
+
+    if (*start == '-' || (*start >= '0' && *start <= '9'))
+    {
+        slice->data = start;
+        slice->size = (int) (this->pos - start);
+        slice->escaped = false;
+        slice->ascii = true;
+    }
+
+    return true;
+}
+
+bool DatagramDecoder::parseNumber(double *value)
+{
+    // Strings or literals leave the value untouched
+    if (this->pos >= this->end ||
+        (*this->pos != '-' && (*this->pos < '0' || *this->pos > '9')))
+        return this->skipValue();
+
+    const char *c = this->pos;
+    if (!this->skipNumber())
+        return false;
+
+    // Locale independent conversion of the JSON number grammar
+    bool negative = (*c == '-');
+    if (negative)
+        ++c;
+
+    double result = 0;
+    while (c < this->pos && *c >= '0' && *c <= '9')
+        result = result * 10 + (*c++ - '0');
+
+    if (c < this->pos && *c == '.')
+    {
+        double scale = 0.1;
+        for (++c; c < this->pos && *c >= '0' && *c <= '9'; ++c)
+        {
+            result += (*c - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    if (c < this->pos && (*c == 'e' || *c == 'E'))
+    {
+        ++c;
+        bool negativeExponent = (c < this->pos && *c == '-');
+        if (c < this->pos && (*c == '-' || *c == '+'))
+            ++c;
+
+        int exponent = 0;
+        while (c < this->pos && *c >= '0' && *c <= '9' && exponent < 400)
+            exponent = exponent * 10 + (*c++ - '0');
+
+        double factor = 1;
+        for (int x = 0; x < exponent; ++x)
+            factor *= 10;
+        result = negativeExponent ? result / factor : result * factor;
+    }
+
+    *value = negative ? -result : result;
+    return true;
+}
+
+bool DatagramDecoder::skipValue()
+{
+    if (this->pos >= this->end)
+        return false;
+
+    JsonSlice dummy;
+    char c = *this->pos;
+    switch (c)
+    {
+        case '"':
+            return this->parseString(&dummy);
+        case 't':
+            return this->skipLiteral("true");
+        case 'f':
+            return this->skipLiteral("false");
+        case 'n':
+            return this->skipLiteral("null");
+        case '{':
+        case '[':
+            break;
+        default:
+            return this->skipNumber();
+    }
+
+    // Objects and arrays
+    if (++this->depth > MAX_DEPTH)
+        return false;
+
+    char close = (c == '{') ? '}' : ']';
+    ++this->pos;
+    this->skipWhitespace();
+    if (this->pos < this->end && *this->pos == close)
+    {
+        ++this->pos;
+        --this->depth;
+        return true;
+    }
+
+    while (true)
+    {
+        if (close == '}')
+        {
+            if (!this->parseString(&dummy))
+                return false;
+            this->skipWhitespace();
+            if (this->pos >= this->end || *this->pos != ':')
+                return false;
+            ++this->pos;
+            this->skipWhitespace();
+        }
+
+        if (!this->skipValue())
+            return false;
+
+        this->skipWhitespace();
+        if (this->pos >= this->end)
+            return false;
+        if (*this->pos == close)
+        {
+            ++this->pos;
+            break;
+        }
+        if (*this->pos != ',')
+            return false;
+        ++this->pos;
+        this->skipWhitespace();
+    }
+
+    --this->depth;
+    return true;
+}
+
+bool DatagramDecoder::skipLiteral(const char *literal)
+{
+    int length = (int) strlen(literal);
+    if (this->end - this->pos < length ||
+        memcmp(this->pos, literal, length) != 0)
+        return false;
+
+    this->pos += length;
+    return true;
+}
+
+bool DatagramDecoder::skipNumber()
+{
+    const char *start = this->pos;
+    while (this->pos < this->end &&
+           ((*this->pos >= '0' && *this->pos <= '9') || *this->pos == '-' ||
+            *this->pos == '+' || *this->pos == '.' || *this->pos == 'e' ||
+            *this->pos == 'E'))
+        ++this->pos;
+
+    return this->pos > start;
+}
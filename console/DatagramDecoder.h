@@ -0,0 +1,92 @@
+#ifndef DATAGRAMDECODER_H
+#define DATAGRAMDECODER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#define DATAGRAM_LOGS 5
+
+/**
+* JSON string value as found in the receive buffer, quotes excluded and
+* escape sequences still in place
+*/
+struct JsonSlice
+{
+    const char *data;   /**< First byte after the opening quote  */
+    int size;           /**< Bytes up to the closing quote        */
+    bool escaped;       /**< Contains backslash escape sequences */
+    bool ascii;         /**< Contains only 7 bit characters      */
+
+    JsonSlice() : data(NULL), size(0), escaped(false), ascii(true) {}
+
+    bool isEmpty() const { return this->size == 0; }
+    bool equals(const char *text) const;
+    bool equals(const QByteArray &bytes) const;
+    QString toString() const;
+};
+
+/**
+* Timing span. Start and duration are in milliseconds.
+*/
+struct DatagramSpan
+{
+    JsonSlice name;     /**< Operation name                      */
+    JsonSlice id;       /**< Span id, string or number as sent   */
+    JsonSlice parent;   /**< Parent span id, empty for requests  */
+    double start;
+    double duration;
+};
+
+/**
+* Single pass decoder for console datagrams. Only the fields the console
+* routes on (tabs, log1 to log5, level and span) are extracted, everything
+* else is validated and skipped without being stored.
+*
+* Slices point into the decoded datagram, so it must outlive them.
+*/
+class DatagramDecoder
+{
+public:
+    DatagramDecoder();
+
+    bool decode(const QByteArray &datagram);
+
+    bool hasTabs() const { return this->tabsFound; }
+    int tabCount() const { return this->tabsCount; }
+    const JsonSlice &tab(int index) const { return this->tabs[index]; }
+    const JsonSlice &tabsSource() const { return this->tabsRaw; }
+    const JsonSlice &log(int index) const { return this->logs[index]; }
+    int level() const { return this->levelValue; }
+    int spanCount() const { return this->spansCount; }
+    const DatagramSpan &span(int index) const { return this->spans[index]; }
+
+private:
+    const char *pos;
+    const char *end;
+    int depth;
+
+    bool tabsFound;
+    int tabsCount;
+    JsonSlice tabs[DATAGRAM_LOGS];
+    JsonSlice tabsRaw;
+    JsonSlice logs[DATAGRAM_LOGS];
+    int levelValue;
+    QVector<DatagramSpan> spans;
+    int spansCount;
+
+    void reset();
+    void skipWhitespace();
+    bool parseString(JsonSlice *slice);
+    bool parseTabs();
+    bool parseLevel();
+    bool parseSpans();
+    bool parseSpan();
+    bool parseId(JsonSlice *slice);
+    bool parseNumber(double *value);
+    bool skipValue();
+    bool skipLiteral(const char *literal);
+    bool skipNumber();
+};
+
+#endif // DATAGRAMDECODER_H
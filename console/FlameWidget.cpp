@@ -0,0 +1,102 @@
+#include "FlameWidget.h"
+
+#include <QPainter>
+#include <QHelpEvent>
+#include <QToolTip>
+
+// Height of each nesting level, in pixels
+#define FLAME_ROW_HEIGHT 20
+
+FlameWidget::FlameWidget(QWidget *parent) :
+    QWidget(parent),
+    depth(0)
+{
+    this->setMinimumHeight(FLAME_ROW_HEIGHT);
+}
+
+void FlameWidget::setSpans(const QVector<FlameSpan> &spans)
+{
+    this->spans = spans;
+
+    this->depth = 0;
+    for (int x = 0; x < spans.size(); ++x)
+        this->depth = qMax(this->depth, spans.at(x).depth + 1);
+
+    this->setMinimumHeight(qMax(1, this->depth) * FLAME_ROW_HEIGHT);
+    this->update();
+}
+
+QRect FlameWidget::spanRect(const FlameSpan &span) const
+{
+    // The request span fills the width, children are scaled to it
+    double total = this->spans.first().duration;
+    double scale = (total > 0) ? (this->width() - 1) / total : 0;
+
+    int left = (int) (span.start * scale);
+    int width = qMax(1, (int) (span.duration * scale));
+    return QRect(left, span.depth * FLAME_ROW_HEIGHT, width,
+                 FLAME_ROW_HEIGHT - 1);
+}
+
+bool FlameWidget::event(QEvent *event)
+{
+    if (event->type() != QEvent::ToolTip)
+        return QWidget::event(event);
+
+    // Deepest span under the cursor
+    QHelpEvent *help = static_cast<QHelpEvent *>(event);
+    for (int x = this->spans.size() - 1; x >= 0; --x)
+    {
+        const FlameSpan &span = this->spans.at(x);
+        if (this->spanRect(span).contains(help->pos()))
+        {
+            QToolTip::showText(help->globalPos(),
+                               tr("%1\n%2 ms, starts at %3 ms")
+                               .arg(span.name)
+                               .arg(span.duration, 0, 'f', 3)
+                               .arg(span.start, 0, 'f', 3), this);
+            return true;
+        }
+    }
+
+    QToolTip::hideText();
+    event->ignore();
+    return true;
+}
+
+void FlameWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(this->rect(), this->palette().base());
+
+    if (this->spans.isEmpty())
+    {
+        painter.setPen(this->palette().mid().color());
+        painter.drawText(this->rect(), Qt::AlignCenter,
+                         tr("Select a request to see its spans"));
+        return;
+    }
+
+    for (int x = 0; x < this->spans.size(); ++x)
+    {
+        const FlameSpan &span = this->spans.at(x);
+        QRect rect = this->spanRect(span);
+
+        // Same name, same color
+        QColor color = QColor::fromHsv(qHash(span.name) % 360, 90, 230);
+        painter.fillRect(rect, color);
+        painter.setPen(color.darker(130));
+        painter.drawRect(rect.adjusted(0, 0, -1, 0));
+
+        if (rect.width() > 30)
+        {
+            painter.setPen(this->palette().text().color());
+            QRect text = rect.adjusted(3, 0, -3, 0);
+            painter.drawText(text, Qt::AlignVCenter | Qt::AlignLeft,
+                             this->fontMetrics().elidedText(span.name,
+                                               Qt::ElideRight, text.width()));
+        }
+    }
+}
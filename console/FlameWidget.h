@@ -0,0 +1,33 @@
+#ifndef FLAMEWIDGET_H
+#define FLAMEWIDGET_H
+
+#include <QWidget>
+#include <QVector>
+
+#include "SpanAggregator.h"
+
+/**
+* Call tree of a single request. Each span is a bar placed by its start and
+* duration, one row per nesting level with the request on top.
+*/
+class FlameWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FlameWidget(QWidget *parent = 0);
+
+    void setSpans(const QVector<FlameSpan> &spans);
+
+protected:
+    bool event(QEvent *event);
+    void paintEvent(QPaintEvent *event);
+
+private:
+    QVector<FlameSpan> spans;
+    int depth;
+
+    QRect spanRect(const FlameSpan &span) const;
+};
+
+#endif // FLAMEWIDGET_H
@@ -0,0 +1,112 @@
+#include "HistoryModel.h"
+
+#include <QDateTime>
+#include <QRegExp>
+#include <climits>
+
+// Characters of a message shown in the table
+#define PREVIEW_LENGTH 300
+
+static QString plainText(QString html)
+{
+    static const QRegExp tags("<[^>]*>");
+
+    html.replace("<br />", " ").replace("<br>", " ");
+    html.remove(tags);
+    html.replace("&lt;", "<").replace("&gt;", ">").replace("&quot;", "\"")
+        .replace("&nbsp;", " ").replace("&amp;", "&");
+
+    return html.simplified();
+}
+
+HistoryModel::HistoryModel(HistoryStore *store, QObject *parent) :
+    QAbstractTableModel(parent),
+    store(store), rows(0), base(0)
+{
+    this->refresh();
+}
+
+void HistoryModel::setTabCaptions(const QStringList &captions)
+{
+    this->tabCaptions = captions;
+    if (this->rows > 0)
+        emit dataChanged(this->index(0, 1), this->index(this->rows - 1, 1));
+}
+
+void HistoryModel::refresh()
+{
+    qint64 count = qMin(this->store->count(), (qint64) INT_MAX);
+
+    // Rows are numbered from the oldest message kept, so dropping old
+    // segments renumbers everything
+    if (this->store->base() != this->base || count < this->rows)
+    {
+        this->beginResetModel();
+        this->base = this->store->base();
+        this->rows = (int) count;
+        this->endResetModel();
+    }
+    else if (count > this->rows)
+    {
+        this->beginInsertRows(QModelIndex(), this->rows, (int) count - 1);
+        this->rows = (int) count;
+        this->endInsertRows();
+    }
+}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : this->rows;
+}
+
+int HistoryModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 3;
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() ||
+        (role != Qt::DisplayRole && role != Qt::ToolTipRole))
+        return QVariant();
+
+    // Until the next refresh() rows keep the numbering they had, even if
+    // old segments were dropped since
+    qint64 row = index.row() + this->base - this->store->base();
+    HistoryEntry entry;
+    if (row < 0 || !this->store->entry(row, &entry))
+        return QVariant();
+
+    switch (index.column())
+    {
+        case 0:
+            return QDateTime::fromMSecsSinceEpoch(entry.time)
+                   .toString("yyyy-MM-dd hh:mm:ss");
+        case 1:
+            if (entry.tab < this->tabCaptions.count())
+                return QString(this->tabCaptions.at(entry.tab))
+                       .replace("&", "");
+            return tr("Log %1").arg(entry.tab + 1);
+    }
+
+    QString text = plainText(this->store->message(row));
+    if (role == Qt::DisplayRole && text.length() > PREVIEW_LENGTH)
+        text = text.left(PREVIEW_LENGTH) + "...";
+
+    return text;
+}
+
+QVariant HistoryModel::headerData(int section, Qt::Orientation orientation,
+                                  int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (section)
+    {
+        case 0: return tr("Time");
+        case 1: return tr("Log");
+    }
+
+    return tr("Message");
+}
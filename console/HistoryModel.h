@@ -0,0 +1,38 @@
+#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStringList>
+
+#include "HistoryStore.h"
+
+/**
+* Table model over the persistent history. Rows are read from the mapped
+* segment files only when a view asks for them.
+*/
+class HistoryModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public slots:
+    void refresh();
+
+public:
+    explicit HistoryModel(HistoryStore *store, QObject *parent = 0);
+
+    void setTabCaptions(const QStringList &captions);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const;
+
+private:
+    HistoryStore *store;
+    int rows;
+    qint64 base;
+    QStringList tabCaptions;
+};
+
+#endif // HISTORYMODEL_H
@@ -0,0 +1,555 @@
+#include "HistoryStore.h"
+
+#include <QDir>
+
+Q_STATIC_ASSERT(sizeof(HistoryEntry) == 24);
+
+static QString segmentName(quint32 number)
+{
+    return QString("%1").arg(number, 8, 10, QChar('0'));
+}
+
+static char foldAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Case insensitive (ASCII only) search of an already folded needle. Uses
+// Horspool skips so most bytes of the data are never compared.
+static qint64 findFolded(const char *data, qint64 size,
+                         const QByteArray &needle)
+{
+    qint64 length = needle.size();
+    const char *pattern = needle.constData();
+
+    qint64 skip[256];
+    for (int x = 0; x < 256; ++x)
+        skip[x] = length;
+    for (qint64 x = 0; x < length - 1; ++x)
+    {
+        skip[(uchar) pattern[x]] = length - 1 - x;
+        if (pattern[x] >= 'a' && pattern[x] <= 'z')
+            skip[(uchar) (pattern[x] - ('a' - 'A'))] = length - 1 - x;
+    }
+
+    for (qint64 x = 0; x + length <= size;
+         x += skip[(uchar) data[x + length - 1]])
+    {
+        qint64 y = length - 1;
+        while (y >= 0 && foldAscii(data[x + y]) == pattern[y])
+            --y;
+        if (y < 0)
+            return x;
+    }
+
+    return -1;
+}
+
+HistoryStore::HistoryStore(QObject *parent) :
+    QObject(parent),
+    maxMessages(5000000), segmentMessages(HISTORY_SEGMENT_MESSAGES),
+    segmentBytes(HISTORY_SEGMENT_BYTES), total(0), flushTimer(NULL)
+{
+    // Writes are buffered and reach the disk at least once per second
+    this->flushTimer = new QTimer(this);
+    connect(this->flushTimer, SIGNAL(timeout()),
+            this,             SLOT(flush()));
+}
+
+HistoryStore::~HistoryStore()
+{
+    this->close();
+}
+
+bool HistoryStore::open(const QString &folder)
+{
+    this->close();
+
+    QDir dir;
+    if (!dir.exists(folder) && !dir.mkpath(folder))
+        return false;
+
+    this->folder = folder;
+    if (!this->folder.endsWith("/"))
+        this->folder += "/";
+
+    // Map every segment left by previous sessions
+    QStringList files = QDir(folder).entryList(QStringList() << "*.idx",
+                                               QDir::Files, QDir::Name);
+    quint32 next = 1;
+    foreach (QString file, files)
+    {
+        bool ok;
+        quint32 number = QFileInfo(file).baseName().toUInt(&ok);
+        if (!ok)
+            continue;
+
+        HistorySegment *segment = this->openSegment(number, this->total);
+        if (segment == NULL)
+            continue;
+
+        this->segments << segment;
+        this->total += segment->count;
+        next = number + 1;
+    }
+
+    // Keep writing to the last segment if it has room, else start a new one
+    HistorySegment *last = this->segments.isEmpty() ? NULL :
+                           this->segments.last();
+    if (last == NULL || last->count >= this->segmentMessages ||
+        last->dataSize >= this->segmentBytes || !this->startWriting(last))
+    {
+        HistorySegment *segment = this->openSegment(next, this->total);
+        if (segment == NULL || !this->startWriting(segment))
+        {
+            if (segment != NULL)
+                this->closeSegment(segment);
+            this->close();
+            return false;
+        }
+        this->segments << segment;
+    }
+
+    this->enforceLimit();
+    this->flushTimer->start(1000);
+
+    return true;
+}
+
+void HistoryStore::close()
+{
+    this->flushTimer->stop();
+
+    foreach (HistorySegment *segment, this->segments)
+        this->closeSegment(segment);
+
+    this->segments.clear();
+    this->total = 0;
+}
+
+void HistoryStore::setLimit(qint64 messages)
+{
+    this->maxMessages = qMax(Q_INT64_C(1), messages);
+    this->enforceLimit();
+}
+
+void HistoryStore::setSegmentSize(qint64 messages, qint64 bytes)
+{
+    // Checked on every append, the active segment included
+    this->segmentMessages = qMax(Q_INT64_C(1), messages);
+    this->segmentBytes = qMax(Q_INT64_C(1), bytes);
+}
+
+HistorySegment *HistoryStore::openSegment(quint32 number, qint64 first)
+{
+    HistorySegment *segment = new HistorySegment;
+    segment->number = number;
+    segment->indexWriter = NULL;
+    segment->dataWriter = NULL;
+    segment->entries = NULL;
+    segment->mappedEntries = 0;
+    segment->bytes = NULL;
+    segment->mappedBytes = 0;
+    segment->count = 0;
+    segment->dataSize = 0;
+    segment->first = first;
+
+    QString name = this->folder + segmentName(number);
+    segment->indexFile.setFileName(name + ".idx");
+    segment->dataFile.setFileName(name + ".log");
+
+    // Create missing files so they can be opened for reading
+    if (!segment->indexFile.exists() || !segment->dataFile.exists())
+    {
+        QFile index(name + ".idx");
+        QFile data(name + ".log");
+        if (!index.open(QIODevice::Append) || !data.open(QIODevice::Append))
+        {
+            delete segment;
+            return NULL;
+        }
+    }
+
+    if (!segment->indexFile.open(QIODevice::ReadOnly) ||
+        !segment->dataFile.open(QIODevice::ReadOnly))
+    {
+        delete segment;
+        return NULL;
+    }
+
+    this->mapSegment(segment);
+
+    return segment;
+}
+
+bool HistoryStore::startWriting(HistorySegment *segment)
+{
+    QString name = this->folder + segmentName(segment->number);
+
+    segment->indexWriter = new QFile(name + ".idx");
+    segment->dataWriter = new QFile(name + ".log");
+    if (!segment->indexWriter->open(QIODevice::Append) ||
+        !segment->dataWriter->open(QIODevice::Append))
+    {
+        delete segment->indexWriter;
+        delete segment->dataWriter;
+        segment->indexWriter = NULL;
+        segment->dataWriter = NULL;
+        return false;
+    }
+
+    // Drop records discarded when the segment was opened. Mapped files
+    // can't be truncated on every system, so the index is unmapped first.
+    qint64 indexSize = segment->count * sizeof(HistoryEntry);
+    bool truncated = true;
+    if (segment->indexWriter->size() > indexSize)
+    {
+        if (segment->entries != NULL)
+            segment->indexFile.unmap((uchar *) segment->entries);
+        segment->entries = NULL;
+        segment->mappedEntries = 0;
+        truncated = segment->indexWriter->resize(indexSize);
+    }
+
+    // New records after stale ones would be read at the wrong rows
+    if (!truncated)
+    {
+        delete segment->indexWriter;
+        delete segment->dataWriter;
+        segment->indexWriter = NULL;
+        segment->dataWriter = NULL;
+        this->mapSegment(segment);
+        return false;
+    }
+
+    this->mapSegment(segment);
+    return true;
+}
+
+void HistoryStore::mapSegment(HistorySegment *segment)
+{
+    if (segment->entries != NULL)
+        segment->indexFile.unmap((uchar *) segment->entries);
+    if (segment->bytes != NULL)
+        segment->dataFile.unmap((uchar *) segment->bytes);
+
+    segment->entries = NULL;
+    segment->mappedEntries = 0;
+    segment->bytes = NULL;
+    segment->mappedBytes = 0;
+
+    qint64 indexSize = segment->indexFile.size();
+    qint64 dataSize = segment->dataFile.size();
+
+    indexSize -= indexSize % sizeof(HistoryEntry);
+    if (indexSize > 0)
+    {
+        segment->entries = (const HistoryEntry *)
+                           segment->indexFile.map(0, indexSize);
+        if (segment->entries != NULL)
+            segment->mappedEntries = indexSize / sizeof(HistoryEntry);
+    }
+
+    if (dataSize > 0)
+    {
+        segment->bytes = (const char *) segment->dataFile.map(0, dataSize);
+        if (segment->bytes != NULL)
+            segment->mappedBytes = dataSize;
+    }
+
+    // Only the active segment grows, so sizes are taken from the files
+    // just for segments that are not being written
+    if (segment->indexWriter == NULL)
+    {
+        segment->count = segment->mappedEntries;
+        segment->dataSize = segment->mappedBytes;
+
+        // A crash may leave index records for data that never reached
+        // the disk
+        while (segment->count > 0)
+        {
+            const HistoryEntry &last = segment->entries[segment->count - 1];
+            if (last.offset + last.length <= (quint64) segment->dataSize)
+                break;
+            --segment->count;
+        }
+    }
+}
+
+void HistoryStore::closeSegment(HistorySegment *segment)
+{
+    if (segment->indexWriter != NULL)
+    {
+        // Data first, so index records never point past the data file
+        segment->dataWriter->flush();
+        segment->indexWriter->flush();
+        delete segment->dataWriter;
+        delete segment->indexWriter;
+    }
+
+    if (segment->entries != NULL)
+        segment->indexFile.unmap((uchar *) segment->entries);
+    if (segment->bytes != NULL)
+        segment->dataFile.unmap((uchar *) segment->bytes);
+
+    delete segment;
+}
+
+void HistoryStore::flush()
+{
+    if (this->segments.isEmpty())
+        return;
+
+    HistorySegment *active = this->segments.last();
+    if (active->indexWriter == NULL)
+        return;
+
+    active->dataWriter->flush();
+    active->indexWriter->flush();
+}
+
+void HistoryStore::append(qint64 time, int tab, int level,
+                          const QByteArray &message)
+{
+    if (this->segments.isEmpty())
+        return;
+
+    // Start a new segment when the active one is full
+    HistorySegment *active = this->segments.last();
+    if (active->count >= this->segmentMessages ||
+        active->dataSize + message.size() > this->segmentBytes)
+    {
+        HistorySegment *segment = this->openSegment(active->number + 1,
+                                                    this->total);
+        if (segment == NULL || !this->startWriting(segment))
+        {
+            if (segment != NULL)
+                this->closeSegment(segment);
+            return;
+        }
+
+        // The previous segment is final now, map it whole
+        active->dataWriter->flush();
+        active->indexWriter->flush();
+        delete active->dataWriter;
+        delete active->indexWriter;
+        active->dataWriter = NULL;
+        active->indexWriter = NULL;
+        this->mapSegment(active);
+
+        this->segments << segment;
+        active = segment;
+    }
+
+    HistoryEntry entry;
+    entry.offset = active->dataSize;
+    entry.time = time;
+    entry.length = message.size();
+    entry.tab = tab;
+    entry.level = level;
+    entry.reserved = 0;
+
+    active->dataWriter->write(message);
+    active->indexWriter->write((const char *) &entry, sizeof(HistoryEntry));
+    active->dataSize += message.size();
+    ++active->count;
+    ++this->total;
+
+    this->enforceLimit();
+}
+
+void HistoryStore::enforceLimit()
+{
+    // Whole segments are dropped, so at least the limit is always kept
+    while (this->segments.count() > 1)
+    {
+        HistorySegment *oldest = this->segments.first();
+        if (this->total - oldest->first - oldest->count < this->maxMessages)
+            break;
+
+        QString name = this->folder + segmentName(oldest->number);
+        this->segments.removeFirst();
+        this->closeSegment(oldest);
+        QFile::remove(name + ".idx");
+        QFile::remove(name + ".log");
+    }
+}
+
+qint64 HistoryStore::base() const
+{
+    if (this->segments.isEmpty())
+        return 0;
+
+    return this->segments.first()->first;
+}
+
+qint64 HistoryStore::count() const
+{
+    return this->total - this->base();
+}
+
+HistorySegment *HistoryStore::segmentFor(qint64 global)
+{
+    // Binary search on the first message of each segment
+    int low = 0;
+    int high = this->segments.count() - 1;
+    while (low < high)
+    {
+        int middle = (low + high + 1) / 2;
+        if (this->segments.at(middle)->first <= global)
+            low = middle;
+        else high = middle - 1;
+    }
+
+    if (high < 0)
+        return NULL;
+
+    HistorySegment *segment = this->segments.at(low);
+    if (global < segment->first || global >= segment->first + segment->count)
+        return NULL;
+
+    return segment;
+}
+
+bool HistoryStore::entry(qint64 row, HistoryEntry *entry)
+{
+    HistorySegment *segment = this->segmentFor(this->base() + row);
+    if (segment == NULL)
+        return false;
+
+    qint64 local = this->base() + row - segment->first;
+
+    // Rows written after the last mapping need a fresh one
+    if (local >= segment->mappedEntries)
+    {
+        this->flush();
+        this->mapSegment(segment);
+        if (local >= segment->mappedEntries)
+            return false;
+    }
+
+    *entry = segment->entries[local];
+    return true;
+}
+
+QString HistoryStore::message(qint64 row)
+{
+    HistoryEntry entry;
+    if (!this->entry(row, &entry))
+        return QString();
+
+    HistorySegment *segment = this->segmentFor(this->base() + row);
+    if (entry.offset + entry.length > (quint64) segment->mappedBytes)
+    {
+        this->flush();
+        this->mapSegment(segment);
+        if (entry.offset + entry.length > (quint64) segment->mappedBytes)
+            return QString();
+    }
+
+    return QString::fromUtf8(segment->bytes + entry.offset, entry.length);
+}
+
+qint64 HistoryStore::find(const QString &text, qint64 *from, qint64 to,
+                          qint64 maxBytes)
+{
+    QByteArray needle = text.toUtf8();
+    for (int x = 0; x < needle.size(); ++x)
+        needle[x] = foldAscii(needle.at(x));
+
+    to = qMin(to, this->count());
+    *from = qMax(Q_INT64_C(0), *from);
+    if (needle.isEmpty() || *from >= to)
+    {
+        *from = to;
+        return -1;
+    }
+
+    // Messages are stored one after the other, so each segment is searched
+    // in a single pass over its data file
+    this->flush();
+
+    qint64 base = this->base();
+    qint64 global = base + *from;
+    qint64 stop = base + to;
+    qint64 budget = qMax(Q_INT64_C(1), maxBytes);
+    int index = this->segments.indexOf(this->segmentFor(global));
+    if (index < 0)
+    {
+        *from = to;
+        return -1;
+    }
+
+    for (; index < this->segments.count() && global < stop; ++index)
+    {
+        HistorySegment *segment = this->segments.at(index);
+        if (segment->mappedEntries < segment->count)
+            this->mapSegment(segment);
+
+        qint64 count = qMin(segment->count, segment->mappedEntries);
+        count = qMin(count, stop - segment->first);
+        qint64 local = qMax(Q_INT64_C(0), global - segment->first);
+        if (local >= count)
+        {
+            global = segment->first + segment->count;
+            continue;
+        }
+
+        // Whole messages, up to the byte budget of this call
+        qint64 position = segment->entries[local].offset;
+        qint64 low = local;
+        qint64 high = count - 1;
+        while (low < high)
+        {
+            qint64 middle = (low + high + 1) / 2;
+            if ((qint64) segment->entries[middle].offset < position + budget)
+                low = middle;
+            else high = middle - 1;
+        }
+        qint64 last = low;
+
+        const HistoryEntry &lastEntry = segment->entries[last];
+        qint64 end = qMin((qint64) (lastEntry.offset + lastEntry.length),
+                          segment->mappedBytes);
+        qint64 start = position;
+
+        while (position < end)
+        {
+            qint64 found = findFolded(segment->bytes + position,
+                                      end - position, needle);
+            if (found < 0)
+                break;
+            found += position;
+
+            // Message holding the match
+            low = local;
+            high = last;
+            while (low < high)
+            {
+                qint64 middle = (low + high + 1) / 2;
+                if ((qint64) segment->entries[middle].offset <= found)
+                    low = middle;
+                else high = middle - 1;
+            }
+
+            // Matches spanning two messages don't count
+            const HistoryEntry &hit = segment->entries[low];
+            if (found + needle.size() <= (qint64) (hit.offset + hit.length))
+            {
+                *from = segment->first + low + 1 - base;
+                return segment->first + low - base;
+            }
+
+            position = found + 1;
+        }
+
+        global = segment->first + last + 1;
+        budget -= end - start;
+        if (budget <= 0)
+            break;
+    }
+
+    // Past the last segment there is nothing left to search
+    *from = (index < this->segments.count()) ? qMin(global, stop) - base : to;
+    return -1;
+}
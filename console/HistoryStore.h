@@ -0,0 +1,103 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QObject>
+#include <QFile>
+#include <QList>
+#include <QTimer>
+
+// Default messages and bytes after which a new segment is started
+#define HISTORY_SEGMENT_MESSAGES (1 << 20)
+#define HISTORY_SEGMENT_BYTES    (Q_INT64_C(256) << 20)
+
+/**
+* Index record of a stored message. Index files are arrays of these.
+*/
+struct HistoryEntry
+{
+    quint64 offset;     /**< Position in the segment data file  */
+    qint64 time;        /**< Reception time, ms since epoch     */
+    quint32 length;     /**< Message size in bytes (UTF-8)      */
+    quint8 tab;         /**< Log the message was sent to        */
+    quint8 level;       /**< Message level, 0 if it had none    */
+    quint16 reserved;
+};
+
+/**
+* Pair of segment files: messages one after the other in the data file and
+* a fixed size HistoryEntry per message in the index file
+*/
+struct HistorySegment
+{
+    quint32 number;
+    QFile indexFile;
+    QFile dataFile;
+    QFile *indexWriter;
+    QFile *dataWriter;
+    const HistoryEntry *entries;
+    qint64 mappedEntries;
+    const char *bytes;
+    qint64 mappedBytes;
+    qint64 count;
+    qint64 dataSize;
+    qint64 first;
+};
+
+/**
+* Persistent message history kept in segment files. Segment files are
+* memory mapped when opened, so messages from previous sessions are
+* available right away without reading or parsing them.
+*
+* Rows are numbered from the oldest message kept.
+*
+* find() searches at most maxBytes of messages per call and returns the row
+* holding the text, or -1 with *from moved past the rows it searched (to
+* once rows up to to are done). Long searches are run a chunk at a time so
+* the GUI keeps responding.
+*/
+class HistoryStore : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void flush();
+
+public:
+    explicit HistoryStore(QObject *parent = 0);
+    ~HistoryStore();
+
+    bool open(const QString &folder);
+    void close();
+    bool isOpen() const { return !this->segments.isEmpty(); }
+
+    void setLimit(qint64 messages);
+    qint64 limit() const { return this->maxMessages; }
+    void setSegmentSize(qint64 messages, qint64 bytes);
+
+    void append(qint64 time, int tab, int level, const QByteArray &message);
+
+    qint64 count() const;
+    qint64 base() const;
+    bool entry(qint64 row, HistoryEntry *entry);
+    QString message(qint64 row);
+    qint64 find(const QString &text, qint64 *from, qint64 to,
+                qint64 maxBytes);
+
+private:
+    QString folder;
+    QList<HistorySegment *> segments;
+    qint64 maxMessages;
+    qint64 segmentMessages;
+    qint64 segmentBytes;
+    qint64 total;
+    QTimer *flushTimer;
+
+    HistorySegment *openSegment(quint32 number, qint64 first);
+    bool startWriting(HistorySegment *segment);
+    void mapSegment(HistorySegment *segment);
+    void closeSegment(HistorySegment *segment);
+    HistorySegment *segmentFor(qint64 global);
+    void enforceLimit();
+};
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,395 @@
+#include "KeywordMatcher.h"
+
+#include <QQueue>
+#include <QSet>
+#include <QVarLengthArray>
+
+#include <algorithm>
+
+#include <string.h>
+
+// Longest entity name and numeric reference (&#x10FFFF;) handled
+#define MAX_ENTITY_LENGTH 10
+
+struct HtmlEntity
+{
+    const char *name;
+    ushort value;
+};
+
+// HTML 4 named character references plus &apos;, sorted by name. These are
+// every reference htmlentities() produces.
+static const HtmlEntity htmlEntities[] =
+{
+    { "AElig", 198 }, { "Aacute", 193 }, { "Acirc", 194 }, { "Agrave", 192 },
+    { "Alpha", 913 }, { "Aring", 197 }, { "Atilde", 195 }, { "Auml", 196 },
+    { "Beta", 914 }, { "Ccedil", 199 }, { "Chi", 935 }, { "Dagger", 8225 },
+    { "Delta", 916 }, { "ETH", 208 }, { "Eacute", 201 }, { "Ecirc", 202 },
+    { "Egrave", 200 }, { "Epsilon", 917 }, { "Eta", 919 }, { "Euml", 203 },
+    { "Gamma", 915 }, { "Iacute", 205 }, { "Icirc", 206 }, { "Igrave", 204 },
+    { "Iota", 921 }, { "Iuml", 207 }, { "Kappa", 922 }, { "Lambda", 923 },
+    { "Mu", 924 }, { "Ntilde", 209 }, { "Nu", 925 }, { "OElig", 338 },
+    { "Oacute", 211 }, { "Ocirc", 212 }, { "Ograve", 210 }, { "Omega", 937 },
+    { "Omicron", 927 }, { "Oslash", 216 }, { "Otilde", 213 }, { "Ouml", 214 },
+    { "Phi", 934 }, { "Pi", 928 }, { "Prime", 8243 }, { "Psi", 936 },
+    { "Rho", 929 }, { "Scaron", 352 }, { "Sigma", 931 }, { "THORN", 222 },
+    { "Tau", 932 }, { "Theta", 920 }, { "Uacute", 218 }, { "Ucirc", 219 },
+    { "Ugrave", 217 }, { "Upsilon", 933 }, { "Uuml", 220 }, { "Xi", 926 },
+    { "Yacute", 221 }, { "Yuml", 376 }, { "Zeta", 918 }, { "aacute", 225 },
+    { "acirc", 226 }, { "acute", 180 }, { "aelig", 230 }, { "agrave", 224 },
+    { "alefsym", 8501 }, { "alpha", 945 }, { "amp", 38 }, { "and", 8743 },
+    { "ang", 8736 }, { "apos", 39 }, { "aring", 229 }, { "asymp", 8776 },
+    { "atilde", 227 }, { "auml", 228 }, { "bdquo", 8222 }, { "beta", 946 },
+    { "brvbar", 166 }, { "bull", 8226 }, { "cap", 8745 }, { "ccedil", 231 },
+    { "cedil", 184 }, { "cent", 162 }, { "chi", 967 }, { "circ", 710 },
+    { "clubs", 9827 }, { "cong", 8773 }, { "copy", 169 }, { "crarr", 8629 },
+    { "cup", 8746 }, { "curren", 164 }, { "dArr", 8659 }, { "dagger", 8224 },
+    { "darr", 8595 }, { "deg", 176 }, { "delta", 948 }, { "diams", 9830 },
+    { "divide", 247 }, { "eacute", 233 }, { "ecirc", 234 }, { "egrave", 232 },
+    { "empty", 8709 }, { "emsp", 8195 }, { "ensp", 8194 }, { "epsilon", 949 },
+    { "equiv", 8801 }, { "eta", 951 }, { "eth", 240 }, { "euml", 235 },
+    { "euro", 8364 }, { "exist", 8707 }, { "fnof", 402 }, { "forall", 8704 },
+    { "frac12", 189 }, { "frac14", 188 }, { "frac34", 190 },
+    { "frasl", 8260 }, { "gamma", 947 }, { "ge", 8805 }, { "gt", 62 },
+    { "hArr", 8660 }, { "harr", 8596 }, { "hearts", 9829 },
+    { "hellip", 8230 }, { "iacute", 237 }, { "icirc", 238 }, { "iexcl", 161 },
+    { "igrave", 236 }, { "image", 8465 }, { "infin", 8734 }, { "int", 8747 },
+    { "iota", 953 }, { "iquest", 191 }, { "isin", 8712 }, { "iuml", 239 },
+    { "kappa", 954 }, { "lArr", 8656 }, { "lambda", 955 }, { "lang", 9001 },
+    { "laquo", 171 }, { "larr", 8592 }, { "lceil", 8968 }, { "ldquo", 8220 },
+    { "le", 8804 }, { "lfloor", 8970 }, { "lowast", 8727 }, { "loz", 9674 },
+    { "lrm", 8206 }, { "lsaquo", 8249 }, { "lsquo", 8216 }, { "lt", 60 },
+    { "macr", 175 }, { "mdash", 8212 }, { "micro", 181 }, { "middot", 183 },
+    { "minus", 8722 }, { "mu", 956 }, { "nabla", 8711 }, { "nbsp", 160 },
+    { "ndash", 8211 }, { "ne", 8800 }, { "ni", 8715 }, { "not", 172 },
+    { "notin", 8713 }, { "nsub", 8836 }, { "ntilde", 241 }, { "nu", 957 },
+    { "oacute", 243 }, { "ocirc", 244 }, { "oelig", 339 }, { "ograve", 242 },
+    { "oline", 8254 }, { "omega", 969 }, { "omicron", 959 },
+    { "oplus", 8853 }, { "or", 8744 }, { "ordf", 170 }, { "ordm", 186 },
+    { "oslash", 248 }, { "otilde", 245 }, { "otimes", 8855 }, { "ouml", 246 },
+    { "para", 182 }, { "part", 8706 }, { "permil", 8240 }, { "perp", 8869 },
+    { "phi", 966 }, { "pi", 960 }, { "piv", 982 }, { "plusmn", 177 },
+    { "pound", 163 }, { "prime", 8242 }, { "prod", 8719 }, { "prop", 8733 },
+    { "psi", 968 }, { "quot", 34 }, { "rArr", 8658 }, { "radic", 8730 },
+    { "rang", 9002 }, { "raquo", 187 }, { "rarr", 8594 }, { "rceil", 8969 },
+    { "rdquo", 8221 }, { "real", 8476 }, { "reg", 174 }, { "rfloor", 8971 },
+    { "rho", 961 }, { "rlm", 8207 }, { "rsaquo", 8250 }, { "rsquo", 8217 },
+    { "sbquo", 8218 }, { "scaron", 353 }, { "sdot", 8901 }, { "sect", 167 },
+    { "shy", 173 }, { "sigma", 963 }, { "sigmaf", 962 }, { "sim", 8764 },
+    { "spades", 9824 }, { "sub", 8834 }, { "sube", 8838 }, { "sum", 8721 },
+    { "sup", 8835 }, { "sup1", 185 }, { "sup2", 178 }, { "sup3", 179 },
+    { "supe", 8839 }, { "szlig", 223 }, { "tau", 964 }, { "there4", 8756 },
+    { "theta", 952 }, { "thetasym", 977 }, { "thinsp", 8201 },
+    { "thorn", 254 }, { "tilde", 732 }, { "times", 215 }, { "trade", 8482 },
+    { "uArr", 8657 }, { "uacute", 250 }, { "uarr", 8593 }, { "ucirc", 251 },
+    { "ugrave", 249 }, { "uml", 168 }, { "upsih", 978 }, { "upsilon", 965 },
+    { "uuml", 252 }, { "weierp", 8472 }, { "xi", 958 }, { "yacute", 253 },
+    { "yen", 165 }, { "yuml", 255 }, { "zeta", 950 }, { "zwj", 8205 },
+    { "zwnj", 8204 }
+};
+
+static ushort foldChar(ushort c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c + ('a' - 'A');
+    if (c < 128)
+        return c;
+
+    // Non breaking spaces match plain ones
+    if (c == 0xa0)
+        return ' ';
+
+    return QChar(c).toCaseFolded().unicode();
+}
+
+static bool entityBefore(const HtmlEntity &entity, const char *name)
+{
+    return strcmp(entity.name, name) < 0;
+}
+
+// Decodes the character reference starting at data[x], which is a '&'.
+// Returns the position of its ';', or x if it isn't a known reference.
+static int decodeEntity(const QChar *data, int size, int x, ushort *c)
+{
+    char name[MAX_ENTITY_LENGTH + 1];
+    int length = 0;
+    int end = x + 1;
+    while (end < size && length < MAX_ENTITY_LENGTH)
+    {
+        ushort next = data[end].unicode();
+        if (next == ';')
+            break;
+        if (next >= 128)
+            return x;
+
+        name[length++] = (char) next;
+        ++end;
+    }
+
+    if (end >= size || data[end].unicode() != ';' || length == 0)
+        return x;
+    name[length] = 0;
+
+    // Numeric references, decimal or hexadecimal
+    if (name[0] == '#')
+    {
+        bool hex = (name[1] == 'x' || name[1] == 'X');
+        bool ok = false;
+        uint value = QByteArray(name + (hex ? 2 : 1)).toUInt(&ok,
+                                                             hex ? 16 : 10);
+        if (!ok || value == 0 || value > 0xffff)
+            return x;
+
+        *c = (ushort) value;
+        return end;
+    }
+
+    const HtmlEntity *last = htmlEntities + sizeof(htmlEntities) /
+                                            sizeof(HtmlEntity);
+    const HtmlEntity *entity = std::lower_bound(htmlEntities, last, name,
+                                                entityBefore);
+    if (entity == last || strcmp(entity->name, name) != 0)
+        return x;
+
+    *c = entity->value;
+    return end;
+}
+
+static bool matchBefore(const KeywordMatch &a, const KeywordMatch &b)
+{
+    if (a.start != b.start)
+        return a.start < b.start;
+
+    return a.length > b.length;
+}
+
+KeywordMatcher::KeywordMatcher() :
+    classCount(1), longestKey(0)
+{
+    memset(this->latinClass, 0, sizeof(this->latinClass));
+}
+
+int KeywordMatcher::classOf(ushort c) const
+{
+    if (c < 256)
+        return this->latinClass[c];
+
+    return this->otherClass.value(foldChar(c), 0);
+}
+
+void KeywordMatcher::addKey(const QString &key, int index,
+                            QVector<QVector<int> > *trie,
+                            QVector<QVector<int> > *found)
+{
+    int state = 0;
+    for (int x = 0; x < key.size(); ++x)
+    {
+        int c = this->classOf(key.at(x).unicode());
+        int next = (*trie)[state][c];
+        if (next <= 0)
+        {
+            next = trie->size();
+            trie->append(QVector<int>(this->classCount, -1));
+            found->append(QVector<int>());
+            (*trie)[state][c] = next;
+        }
+        state = next;
+    }
+
+    (*found)[state].append(index);
+}
+
+void KeywordMatcher::compile(const QStringList &patterns)
+{
+    this->patternList.clear();
+    this->classCount = 1;
+    memset(this->latinClass, 0, sizeof(this->latinClass));
+    this->otherClass.clear();
+    this->transitions.clear();
+    this->outputStart.clear();
+    this->outputs.clear();
+    this->keyLengths.clear();
+    this->longestKey = 0;
+
+    // Keys are folded the same way scanned characters are
+    QStringList keys;
+    QSet<QString> seen;
+    foreach (QString pattern, patterns)
+    {
+        QString folded(pattern);
+        for (int x = 0; x < folded.size(); ++x)
+            folded[x] = QChar(foldChar(folded.at(x).unicode()));
+
+        // Patterns differing only in case would be counted twice
+        if (folded.isEmpty() || seen.contains(folded))
+            continue;
+        seen.insert(folded);
+
+        this->patternList << pattern;
+        keys << folded;
+        this->keyLengths << folded.size();
+        this->longestKey = qMax(this->longestKey, folded.size());
+    }
+
+    if (keys.isEmpty())
+        return;
+
+    // Alphabet compression: one class per distinct character in the keys,
+    // class 0 for everything else
+    foreach (QString key, keys)
+    {
+        for (int x = 0; x < key.size(); ++x)
+        {
+            ushort c = key.at(x).unicode();
+            if (this->classOf(c) != 0)
+                continue;
+
+            // Every Latin-1 character folding to this one shares its class
+            ushort cls = (ushort) this->classCount++;
+            if (c >= 256)
+                this->otherClass.insert(c, cls);
+            else this->latinClass[c] = cls;
+
+            for (int y = 0; y < 256; ++y)
+            {
+                if (foldChar((ushort) y) == c)
+                    this->latinClass[y] = cls;
+            }
+        }
+    }
+
+    // Trie of the keys
+    QVector<QVector<int> > trie;
+    QVector<QVector<int> > found;
+    trie.append(QVector<int>(this->classCount, -1));
+    found.append(QVector<int>());
+    for (int x = 0; x < keys.count(); ++x)
+        this->addKey(keys.at(x), x, &trie, &found);
+
+    // Breadth first pass turning the trie into a full transition table.
+    // Missing transitions take the one of the failure state, and outputs
+    // of failure states are inherited.
+    int states = trie.size();
+    QVector<int> failure(states, 0);
+    QQueue<int> pending;
+    for (int c = 0; c < this->classCount; ++c)
+    {
+        int next = trie[0][c];
+        if (next > 0)
+            pending.enqueue(next);
+        else trie[0][c] = 0;
+    }
+
+    while (!pending.isEmpty())
+    {
+        int state = pending.dequeue();
+        found[state] += found.at(failure.at(state));
+
+        for (int c = 0; c < this->classCount; ++c)
+        {
+            int next = trie[state][c];
+            if (next > 0)
+            {
+                failure[next] = trie[failure.at(state)][c];
+                pending.enqueue(next);
+            }
+            else trie[state][c] = trie[failure.at(state)][c];
+        }
+    }
+
+    // Flatten everything for the scan loop
+    this->transitions.reserve(states * this->classCount);
+    this->outputStart.reserve(states + 1);
+    for (int state = 0; state < states; ++state)
+    {
+        this->transitions += trie.at(state);
+        this->outputStart << this->outputs.size();
+        this->outputs += found.at(state);
+    }
+    this->outputStart << this->outputs.size();
+}
+
+bool KeywordMatcher::scan(const QString &text,
+                          QVector<KeywordMatch> *matches) const
+{
+    matches->resize(0);
+    if (this->transitions.isEmpty())
+        return false;
+
+    const int *table = this->transitions.constData();
+    const int *starts = this->outputStart.constData();
+    const QChar *data = text.constData();
+    int size = text.size();
+    int state = 0;
+
+    // Where each of the last scanned characters starts in the text, as a
+    // character reference takes several positions for one character
+    QVarLengthArray<int, 64> begins(this->longestKey);
+    int scanned = 0;
+
+    for (int x = 0; x < size; ++x)
+    {
+        ushort c = data[x].unicode();
+        int begin = x;
+
+        // Tag names and attributes are not message text
+        if (c == '<')
+        {
+            while (x < size && data[x].unicode() != '>')
+                ++x;
+            state = 0;
+            continue;
+        }
+
+        if (c == '&')
+            x = decodeEntity(data, size, x, &c);
+        begins[scanned++ % this->longestKey] = begin;
+
+        int cls = (c < 256) ? this->latinClass[c] : this->classOf(c);
+        state = table[state * this->classCount + cls];
+
+        for (int o = starts[state]; o < starts[state + 1]; ++o)
+        {
+            int key = this->outputs.at(o);
+            KeywordMatch match;
+            match.pattern = key;
+            match.start = begins[(scanned - this->keyLengths.at(key)) %
+                                 this->longestKey];
+            match.length = x + 1 - match.start;
+            matches->append(match);
+        }
+    }
+
+    return !matches->isEmpty();
+}
+
+QString KeywordMatcher::highlight(const QString &text,
+                                  const QVector<KeywordMatch> &matches,
+                                  const QString &tag)
+{
+    // Matches are reported by end position. Wrap the leftmost, then longest
+    // ones and skip any overlapping them.
+    QVector<KeywordMatch> ordered(matches);
+    std::sort(ordered.begin(), ordered.end(), matchBefore);
+
+    QString openTag("<" + tag + ">");
+    QString closeTag("</" + tag + ">");
+
+    QString result;
+    result.reserve(text.size() + ordered.size() * (tag.size() * 2 + 5));
+    int copied = 0;
+    foreach (const KeywordMatch &match, ordered)
+    {
+        if (match.start < copied)
+            continue;
+
+        result += text.midRef(copied, match.start - copied);
+        result += openTag;
+        result += text.midRef(match.start, match.length);
+        result += closeTag;
+        copied = match.start + match.length;
+    }
+    result += text.midRef(copied);
+
+    return result;
+}
@@ -0,0 +1,66 @@
+#ifndef KEYWORDMATCHER_H
+#define KEYWORDMATCHER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+/**
+* Pattern found in a scanned text
+*/
+struct KeywordMatch
+{
+    int start;      /**< Position of the first character    */
+    int length;     /**< Characters it takes in the text    */
+    int pattern;    /**< Index in the compiled pattern list */
+};
+
+/**
+* Case insensitive multi-pattern matcher. Patterns are compiled into a
+* single Aho-Corasick automaton with every failure transition resolved, so
+* a text is scanned in one pass with one table lookup per character
+* whatever the number of patterns.
+*
+* Characters not used by any pattern share one column of the transition
+* table, which keeps it small with hundreds of patterns.
+*
+* Texts are HTML: tags are skipped and character references (&eacute;,
+* &#039;...) are scanned as the character they stand for. Matches cover
+* whole references, so highlighting them never splits one.
+*/
+class KeywordMatcher
+{
+public:
+    KeywordMatcher();
+
+    void compile(const QStringList &patterns);
+    bool isEmpty() const { return this->patternList.isEmpty(); }
+    int patternCount() const { return this->patternList.count(); }
+    const QString &pattern(int index) const
+    {
+        return this->patternList.at(index);
+    }
+
+    bool scan(const QString &text, QVector<KeywordMatch> *matches) const;
+    static QString highlight(const QString &text,
+                             const QVector<KeywordMatch> &matches,
+                             const QString &tag);
+
+private:
+    QStringList patternList;
+    int classCount;
+    ushort latinClass[256];
+    QHash<ushort, ushort> otherClass;
+    QVector<int> transitions;
+    QVector<int> outputStart;
+    QVector<int> outputs;
+    QVector<int> keyLengths;
+    int longestKey;
+
+    int classOf(ushort c) const;
+    void addKey(const QString &key, int index, QVector<QVector<int> > *trie,
+                QVector<QVector<int> > *found);
+};
+
+#endif // KEYWORDMATCHER_H
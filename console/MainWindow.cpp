@@ -1,11 +1,21 @@
 #include "MainWindow.h"
 #include "ui_MainWindow.h"
 
+#include <QApplication>
+
+#include <algorithm>
+#include <climits>
+
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
-    server(NULL), clearTimer(NULL), scControls(NULL), scAbout(NULL),
-    scLayout(NULL), scExit(NULL), scPreferences(NULL)
+    server(NULL), relayServer(NULL), clearTimer(NULL), resetLogs(false),
+    scControls(NULL), scAbout(NULL), scLayout(NULL), scExit(NULL),
+    scPreferences(NULL), scTimeline(NULL), scHistory(NULL),
+    scProfiler(NULL), configWatcher(NULL), reloadTimer(NULL),
+    logGeneration(0), flushTimer(NULL), history(NULL), historyDialog(NULL),
+    profilerDialog(NULL), watchHits(0), watchPending(0), watchTimer(NULL),
+    trayIcon(NULL)
 {
     ui->setupUi(this);
 
@@ -18,12 +28,19 @@ MainWindow::MainWindow(QWidget *parent) :
     // Set default values
     this->serverIp = QHostAddress::LocalHost;
     this->serverPort = 1947; // Maurina's year of birth
+    this->relayIp = QHostAddress::LocalHost;
+    this->relayPort = 0;
     this->timeoutEnabled = true;
     this->timeoutValue = 2;
     this->logCount.resize(5);
     this->tabCaptions << "Log 1" << "Log 2" << "Log 3" << "Log4" << "Log5";
     this->controlsVisible = true;
     this->layoutType = DetailedLayout;
+    this->timelineVisible = true;
+    this->batchInterval = 100;
+    this->historyEnabled = true;
+    this->historyLimit = 5000000;
+    this->watchAlerts = true;
 
     // Set default styles
     QString defaultSize("font-size : 12px;");
@@ -48,9 +65,20 @@ MainWindow::MainWindow(QWidget *parent) :
     this->styles["h4"]   = defaultFont + " color : #000000; " + defaultSize;
     this->styles["h5"]   = defaultFont + " color : #000000; " + defaultSize;
     this->styles["h6"]   = defaultFont + " color : #000000; " + defaultSize;
+    this->styles["source"] = defaultFont + " color : #7a5ea8; " + defaultSize;
+    this->styles["watch"] = "background-color : #ffe066; font-weight : bold;";
+    this->defaultStyles = this->styles;
 
     // Load config
     this->loadConfig();
+    this->loadWatchlist();
+
+    // Open message history. Segment files are mapped, not read, so this is
+    // quick whatever the history size is.
+    this->history = new HistoryStore(this);
+    this->history->setLimit(this->historyLimit);
+    if (this->historyEnabled)
+        this->history->open(this->userFolder + HISTORY_FOLDER);
 
     // Set up UI
     ui->uiTimeoutEnabled->setChecked(this->timeoutEnabled);
@@ -65,6 +93,28 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->action_Preferences->setShortcut(QKeySequence(tr("Ctrl+P")));
     ui->action_HideCntrls->setShortcut(QKeySequence(tr("Ctrl+H")));
     ui->actionChangeLayout->setShortcut(QKeySequence(tr("Ctrl+L")));
+    ui->actionShowTimeline->setShortcut(QKeySequence(tr("Ctrl+T")));
+    ui->actionShowTimeline->setChecked(this->timelineVisible);
+    ui->actionHistory->setShortcut(QKeySequence(tr("Ctrl+F")));
+    ui->actionHistory->setEnabled(this->history->isOpen());
+    ui->actionProfiler->setShortcut(QKeySequence(tr("Ctrl+R")));
+
+    ui->uiTimeline->setHistory(&this->rateHistory);
+    this->updateTimelineColors();
+    ui->uiShedText->hide();
+    ui->uiWatchText->hide();
+
+    // Watchlist alerts are raised at most once per interval
+    this->watchTimer = new QTimer(this);
+    this->watchTimer->setSingleShot(true);
+    connect(this->watchTimer,       SIGNAL(timeout()),
+            this,                   SLOT(slWatchTimeout()));
+
+    // Batched lanes are rendered by this timer
+    this->flushTimer = new QTimer(this);
+    this->flushTimer->setSingleShot(true);
+    connect(this->flushTimer,       SIGNAL(timeout()),
+            this,                   SLOT(slFlushLanes()));
 
     ui->frameCompactLayoutTop->hide();
     ui->frameCompactLayoutBottom->hide();
@@ -91,12 +141,41 @@ MainWindow::MainWindow(QWidget *parent) :
             this,                   SLOT(slToggleControls()));
     connect(ui->actionChangeLayout, SIGNAL(triggered()),
             this,                   SLOT(slChangeLayout()));
+    connect(ui->actionShowTimeline, SIGNAL(triggered()),
+            this,                   SLOT(slToggleTimeline()));
+    connect(ui->actionHistory,      SIGNAL(triggered()),
+            this,                   SLOT(slShowHistory()));
+    connect(ui->actionProfiler,     SIGNAL(triggered()),
+            this,                   SLOT(slShowProfiler()));
+    connect(ui->tabWidget,          SIGNAL(currentChanged(int)),
+            this,                   SLOT(slTabChanged(int)));
+    connect(ui->uiTimeline,         SIGNAL(spikeClicked(int,qint64,qint64)),
+            this,                   SLOT(slJumpToTime(int,qint64,qint64)));
 
     this->updateControls();
     this->updateLayout();
 
+    // Set up clear timer
+    this->clearTimer = new QTimer(this);
+    connect(this->clearTimer,       SIGNAL(timeout()),
+            this,                   SLOT(slClearTimeout()));
+
     // Start server
-    this->startServer();
+    this->bindServer();
+    this->startRelay();
+    this->slClearLogs();
+
+    // Config files edited by hand are applied as soon as they are saved
+    this->configWatcher = new QFileSystemWatcher(this);
+    this->reloadTimer = new QTimer(this);
+    this->reloadTimer->setSingleShot(true);
+    connect(this->configWatcher,    SIGNAL(fileChanged(QString)),
+            this,                   SLOT(slConfigFileChanged()));
+    connect(this->configWatcher,    SIGNAL(directoryChanged(QString)),
+            this,                   SLOT(slConfigFileChanged()));
+    connect(this->reloadTimer,      SIGNAL(timeout()),
+            this,                   SLOT(slReloadConfig()));
+    this->watchConfigFiles();
 }
 
 MainWindow::~MainWindow()
@@ -105,89 +184,483 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
-void MainWindow::startServer()
+bool MainWindow::bindServer()
 {
-    // Delete any old instances
-    if (this->server != NULL)
-        delete this->server;
-    if (this->clearTimer != NULL)
+    // The new socket is bound before the old one is closed, so datagrams
+    // keep being received while switching. Sockets are bound exclusively,
+    // so another instance can't take the port without notice.
+    QUdpSocket *socket = new QUdpSocket(this);
+    bool bound = socket->bind(this->serverIp, this->serverPort);
+
+    QHostAddress oldIp;
+    quint16 oldPort = 0;
+    if (!bound && socket->error() == QAbstractSocket::AddressInUseError &&
+        this->server != NULL && this->server->localPort() == this->serverPort)
     {
-        this->clearTimer->stop();
-
-        delete this->clearTimer;
-        this->clearTimer = NULL;
+        // The same port on another address may clash with the socket in
+        // use, which has to be drained and released first
+        oldIp = this->server->localAddress();
+        oldPort = this->server->localPort();
+        this->closeServer();
+        bound = socket->bind(this->serverIp, this->serverPort);
     }
 
-    // Set up server
-    this->server = new QUdpSocket(this);
-    if (!this->server->bind(this->serverIp, this->serverPort))
+    if (!bound)
     {
+        delete socket;
+        this->serverError = tr("Server bind failed. "
+                               "Are you running any other instance "
+                               "of Maurina?");
+
+        // Take back the address released above, if any
+        if (this->server == NULL && oldPort != 0)
+        {
+            socket = new QUdpSocket(this);
+            if (socket->bind(oldIp, oldPort))
+            {
+                connect(socket,     SIGNAL(readyRead()),
+                        this,       SLOT(slPendingDatagrams()));
+                this->server = socket;
+            }
+            else delete socket;
+        }
+
+        // Keep the address still in use, which is the one to be saved
+        if (this->server != NULL)
+        {
+            this->serverIp = this->server->localAddress();
+            this->serverPort = this->server->localPort();
+        }
+
         // If controls are hidden show them so the user sees the message
         if (!this->controlsVisible)
             this->slToggleControls();
 
+        this->updateServerStatus();
+        return false;
+    }
+
+    connect(socket,             SIGNAL(readyRead()),
+            this,               SLOT(slPendingDatagrams()));
+
+    this->closeServer();
+    this->server = socket;
+    this->serverError.clear();
+    this->updateServerStatus();
+    return true;
+}
+
+void MainWindow::closeServer()
+{
+    if (this->server == NULL)
+        return;
+
+    // Handle whatever is still queued in the socket before closing it
+    disconnect(this->server, 0, this, 0);
+    this->readDatagrams(this->server, INT_MAX);
+
+    delete this->server;
+    this->server = NULL;
+}
+
+void MainWindow::updateServerStatus()
+{
+    QString status;
+    if (this->server != NULL)
+    {
+        ui->uiStatusIcon->setPixmap(
+                                QPixmap(":/maurina/Resources/ledGreen.png"));
+        status = tr("Listening at %1:%2")
+                 .arg(this->server->localAddress().toString())
+                 .arg(this->server->localPort());
+        if (!this->serverError.isEmpty())
+            status += " - " + this->serverError;
+    }
+    else
+    {
         ui->uiStatusIcon->setPixmap(QPixmap(":/maurina/Resources/ledRed.png"));
-        ui->uiStatusText->setText(tr("Server bind failed. "
-                                      "Are you running any other instance "
-                                      "of Maurina?"));
+        status = this->serverError;
+    }
+
+    if (this->relayServer != NULL)
+    {
+        status += " - " + tr("relays at %1:%2")
+                          .arg(this->relayServer->address().toString())
+                          .arg(this->relayServer->port());
+    }
+    else if (this->relayPort != 0)
+        status += " - " + tr("Relay bind failed at port %1")
+                          .arg(this->relayPort);
+
+    ui->uiStatusText->setText(status);
+}
+
+void MainWindow::watchConfigFiles()
+{
+    // Editors that save by replacing the file make the watcher drop it, so
+    // paths are added again after every change. The folder is watched too
+    // to notice files created after startup.
+    QStringList paths;
+    paths << this->userFolder + CONFIG_FILE << this->userFolder + STYLES_FILE
+          << this->userFolder + WATCHLIST_FILE;
+
+    QStringList watched = this->configWatcher->files();
+    foreach (QString path, paths)
+    {
+        if (!watched.contains(path) && QFile::exists(path))
+            this->configWatcher->addPath(path);
+    }
+
+    if (this->configWatcher->directories().isEmpty())
+        this->configWatcher->addPath(this->userFolder);
+}
+
+void MainWindow::slConfigFileChanged()
+{
+    // Editors often write a file in several steps, wait for the last one
+    this->reloadTimer->start(RELOAD_DELAY);
+}
+
+void MainWindow::slReloadConfig()
+{
+    this->watchConfigFiles();
+
+    // Files are only applied when their contents changed, which also skips
+    // the notifications of our own saveConfig() calls
+    QByteArray data = this->readFile(CONFIG_FILE);
+    if (data != this->configData)
+    {
+        this->configData = data;
+        this->reloadConfig(readSettings(data));
+    }
+
+    data = this->readFile(STYLES_FILE);
+    if (data != this->stylesData)
+    {
+        this->stylesData = data;
+        this->reloadStyles(readSettings(data));
+    }
+
+    data = this->readFile(WATCHLIST_FILE);
+    if (data != this->watchlistData)
+    {
+        this->loadWatchlist();
+        this->updateWatchStatus();
+    }
+}
+
+void MainWindow::reloadConfig(const QHash<QString, QString> &values)
+{
+    // Only entries that differ from the last ones read are applied. Entries
+    // removed from the file keep their current value.
+    QHash<QString, QString> changed;
+    QHashIterator<QString, QString> it(values);
+    while (it.hasNext())
+    {
+        it.next();
+        if (this->configValues.value(it.key()) != it.value())
+            changed.insert(it.key(), it.value());
+    }
+    this->configValues = values;
+
+    if (changed.isEmpty())
         return;
+
+    QHostAddress oldServerIp = this->serverIp;
+    quint16 oldServerPort = this->serverPort;
+    QHostAddress oldRelayIp = this->relayIp;
+    quint16 oldRelayPort = this->relayPort;
+    bool oldControlsVisible = this->controlsVisible;
+    LayoutType oldLayoutType = this->layoutType;
+    QStringList oldTabCaptions = this->tabCaptions;
+    bool oldHistoryEnabled = this->historyEnabled;
+    QRect windowGeometry = this->geometry();
+
+    this->applySettings(changed, &windowGeometry);
+
+    if (windowGeometry != this->geometry())
+        this->setGeometry(windowGeometry);
+
+    // Spin box first, both controls update the two values when changed
+    bool timeoutEnabled = this->timeoutEnabled;
+    ui->uiTimeoutValue->setValue(this->timeoutValue);
+    ui->uiTimeoutEnabled->setChecked(timeoutEnabled);
+
+    if (this->controlsVisible != oldControlsVisible)
+        this->updateControls();
+    ui->uiTimeline->setVisible(this->controlsVisible &&
+                               this->timelineVisible);
+    ui->actionShowTimeline->setChecked(this->timelineVisible);
+
+    if (this->layoutType != oldLayoutType)
+        this->updateLayout();
+    else if (this->tabCaptions != oldTabCaptions)
+        this->setTabCaptions();
+
+    this->history->setLimit(this->historyLimit);
+    if (this->historyEnabled != oldHistoryEnabled)
+    {
+        if (this->historyEnabled)
+            this->history->open(this->userFolder + HISTORY_FOLDER);
+        else this->history->close();
+        ui->actionHistory->setEnabled(this->history->isOpen());
     }
 
-    // Set up clear timer
-    this->clearTimer = new QTimer(this);
+    if (this->serverIp != oldServerIp || this->serverPort != oldServerPort)
+        this->bindServer();
+    if (this->relayIp != oldRelayIp || this->relayPort != oldRelayPort)
+        this->startRelay();
+}
 
-    // Set up connections
-    connect(this->server,       SIGNAL(readyRead()),
-            this,               SLOT(slPendingDatagrams()));
-    connect(this->clearTimer,   SIGNAL(timeout()),
-            this,               SLOT(slClearTimeout()));
-
-    // Update UI
-    ui->uiStatusIcon->setPixmap(QPixmap(":/maurina/Resources/ledGreen.png"));
-    ui->uiStatusText->setText(tr("Listening at %1:%2")
-                              .arg(this->serverIp.toString())
-                              .arg(this->serverPort));
-    this->slClearLogs();
+void MainWindow::reloadStyles(const QHash<QString, QString> &values)
+{
+    // Logs already shown keep their look, new messages use the new styles.
+    // Styles removed from the file go back to their defaults.
+    QHash<QString, QString> styles = this->defaultStyles;
+    QHashIterator<QString, QString> it(values);
+    while (it.hasNext())
+    {
+        it.next();
+        styles[it.key()] = it.value();
+    }
+
+    if (styles == this->styles)
+        return;
+
+    this->styles = styles;
+    this->compileStyles();
+    this->updateTimelineColors();
 }
 
-void MainWindow::slPendingDatagrams()
+void MainWindow::compileStyles()
 {
-    while (this->server->hasPendingDatagrams())
+    // Replacement tags are built once here instead of for every message
+    this->styleTags.clear();
+    foreach (QString key, this->styles.keys())
     {
-        // Clear logs if needed
-        if (this->resetLogs)
+        QString value(this->styles.value(key));
+        value.replace('"', "'");
+
+        StyleTag tag;
+        tag.openTag = "<" + key + ">";
+        tag.closeTag = "</" + key + ">";
+        tag.newOpenTag = "<span style=\"" + value + "\">";
+        tag.newCloseTag = "</span>";
+        if (key == "pre")
         {
-            this->resetLogs = false;
-            this->slClearLogs();
+            tag.newOpenTag = "<pre style=\"" + value + "\">";
+            tag.newCloseTag = "</pre>";
         }
-        // Read datagram
-        QByteArray datagram;
-        datagram.resize(this->server->pendingDatagramSize());
+
+        this->styleTags.append(tag);
+    }
+}
+
+void MainWindow::loadWatchlist()
+{
+    QFile file(this->userFolder + WATCHLIST_FILE);
+    if (!file.exists())
+    {
+        // Leave an empty list so users know where to write it
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            QTextStream out(&file);
+            out << "# Maurina watchlist. Messages containing any of these "
+                   "texts (one per\n# line, case is ignored) are highlighted "
+                   "and raise an alert.\n";
+            file.close();
+        }
+    }
+
+    QStringList patterns;
+    this->watchlistData = this->readFile(WATCHLIST_FILE);
+
+    QTextStream in(this->watchlistData);
+    in.setCodec("UTF-8");
+    while (!in.atEnd())
+    {
+        QString line(in.readLine().trimmed());
+
+        if (line.startsWith("#") || line.isEmpty())
+            continue;
+
+        patterns << line;
+    }
+
+    this->watchlist.compile(patterns);
+    this->watchCounts.fill(0, this->watchlist.patternCount());
+    this->watchHits = 0;
+}
+
+void MainWindow::startRelay()
+{
+    // As with the datagram socket, the new port is opened before the old
+    // one is closed. Relays connected to the old port keep being read until
+    // they disconnect.
+    RelayServer *old = this->relayServer;
+    this->relayServer = NULL;
+
+    if (this->relayPort != 0)
+    {
+        RelayServer *relay = new RelayServer(this);
+        bool listening = relay->listen(this->relayIp, this->relayPort);
+        if (!listening && old != NULL && old->port() == this->relayPort)
+        {
+            old->retire();
+            old = NULL;
+            listening = relay->listen(this->relayIp, this->relayPort);
+        }
+
+        if (listening)
+        {
+            connect(relay,      SIGNAL(batchReceived(QByteArray)),
+                    this,       SLOT(slRelayBatch(QByteArray)));
+            this->relayServer = relay;
+        }
+        else delete relay;
+    }
+
+    if (old != NULL)
+        old->retire();
+
+    this->updateServerStatus();
+}
+
+void MainWindow::slPendingDatagrams()
+{
+    // Under heavy load give the event loop a chance to render batches
+    if (this->server != NULL &&
+        this->readDatagrams(this->server, MAX_DATAGRAMS_PER_READ))
+        QTimer::singleShot(0, this, SLOT(slPendingDatagrams()));
+}
+
+bool MainWindow::readDatagrams(QUdpSocket *socket, int max)
+{
+    int count = 0;
+    while (socket->hasPendingDatagrams())
+    {
+        if (count++ == max)
+            return true;
+
+        // Read datagram. The buffer is reused so it only reallocates when a
+        // bigger datagram than any seen before arrives.
+        this->datagramBuffer.resize(socket->pendingDatagramSize());
         QHostAddress sender;
         quint16 senderPort;
 
-        this->server->readDatagram(datagram.data(), datagram.size(),
-                                   &sender, &senderPort);
+        socket->readDatagram(this->datagramBuffer.data(),
+                             this->datagramBuffer.size(),
+                             &sender, &senderPort);
 
-        // Parse data
-        QVariantMap data =
-                        QJsonDocument::fromJson(datagram).toVariant().toMap();
+        this->processDatagram(this->datagramBuffer);
+    }
 
-        this->tabCaptions = data["tabs"].toStringList();
+    return false;
+}
+
+void MainWindow::slRelayBatch(const QByteArray &batch)
+{
+    // The whole batch is handled at once, datagrams are not copied. Node
+    // names come from the network, so they are escaped before tagging.
+    RelayBatch reader(batch);
+    QString node = reader.node().toHtmlEscaped();
+    QByteArray datagram;
+    while (reader.next(&datagram))
+        this->processDatagram(datagram, node);
+}
+
+void MainWindow::processDatagram(const QByteArray &datagram,
+                                 const QString &source)
+{
+    // Parse data, ignoring malformed datagrams
+    if (!this->decoder.decode(datagram))
+        return;
+
+    if (this->decoder.spanCount() > 0)
+    {
+        this->addSpans();
+
+        // Datagrams carrying only spans don't count as log activity, so
+        // they neither clear the logs nor delay the clear timeout
+        bool hasLogs = false;
+        for (int x = 0; x < DATAGRAM_LOGS && !hasLogs; ++x)
+            hasLogs = !this->decoder.log(x).isEmpty();
+        if (!hasLogs && !this->decoder.hasTabs())
+            return;
+    }
+
+    // Clear logs if needed
+    if (this->resetLogs)
+    {
+        this->resetLogs = false;
+        this->slClearLogs();
+    }
+
+    // Update tabs using datagram info. Senders repeat the same captions in
+    // every datagram so they are only decoded when they change.
+    const JsonSlice &tabs = this->decoder.tabsSource();
+    if (this->decoder.hasTabs() && !tabs.equals(this->lastTabs))
+    {
+        this->lastTabs = QByteArray(tabs.data, tabs.size);
+
+        int count = this->decoder.tabCount();
+        for (int x = 0; x < count && x < this->tabCaptions.count(); ++x)
+            this->tabCaptions[x] = this->decoder.tab(x).toString();
 
-        // Update tabs using datagram info
         this->setTabCaptions();
+    }
+
+    // Classify each log in its priority lane. High priority messages are
+    // shown right away, the rest wait for the next batch.
+    qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+    for (int x = 0; x < DATAGRAM_LOGS; ++x)
+    {
+        const JsonSlice &log = this->decoder.log(x);
+        if (log.isEmpty())
+            continue;
+
+        QString data = log.toString();
+        if (!source.isEmpty())
+            data = "<source>" + source + "</source> " + data;
+
+        int level = this->decoder.level();
+        if (level == 0)
+            level = this->messageLevel(data);
+
+        this->rateHistory.addMessage(now, x, level);
 
-        // Update log windows
-        this->addDataToLog(0, data["log1"].toString());
-        this->addDataToLog(1, data["log2"].toString());
-        this->addDataToLog(2, data["log3"].toString());
-        this->addDataToLog(3, data["log4"].toString());
-        this->addDataToLog(4, data["log5"].toString());
+        // Store every message, even those shed later. Unescaped strings are
+        // already UTF-8 in the datagram and are stored as they are.
+        if (this->history->isOpen())
+        {
+            QByteArray stored = (log.escaped || !source.isEmpty()) ?
+                                data.toUtf8() :
+                                QByteArray::fromRawData(log.data, log.size);
+            this->history->append(QDateTime::currentMSecsSinceEpoch(), x,
+                                  level, stored);
+        }
+
+        // Watched messages are highlighted and shown right away
+        Lane lane = MessageLanes::laneFor(level);
+        if (!this->watchlist.isEmpty() &&
+            this->watchlist.scan(data, &this->watchMatches))
+        {
+            this->countWatchHits(x);
+            data = KeywordMatcher::highlight(data, this->watchMatches,
+                                             "watch");
+            lane = HighLane;
+        }
 
-        // Launch clear timer
-        this->clearTimer->start(this->timeoutValue * 1000);
+        if (lane == HighLane)
+            this->addDataToLog(x, data);
+        else this->lanes.enqueue(lane, x, now, data);
     }
+
+    if (!this->lanes.isEmpty() && !this->flushTimer->isActive())
+        this->flushTimer->start(this->batchInterval);
+
+    // Launch clear timer
+    this->clearTimer->start(this->timeoutValue * 1000);
 }
 
 void MainWindow::slTimeoutChanged(int dummy)
@@ -214,6 +687,13 @@ void MainWindow::slClearLogs()
     ui->uiLog4->clear();
     ui->uiLog5->clear();
 
+    // Timeline anchors taken before this point are no longer valid
+    ++this->logGeneration;
+
+    // Messages waiting in the lanes belong to the cleared session
+    this->lanes.clear();
+    this->updateShedStatus();
+
     this->logCount.fill(0);
     this->setTabCaptions();
 }
@@ -229,21 +709,161 @@ void MainWindow::addDataToLog(int index, QString data)
     if (data.isEmpty())
         return;
 
+    this->appendToLog(index, data,
+                      QDateTime::currentMSecsSinceEpoch() / 1000);
+
+    // Update tab captions
+    this->setTabCaptions();
+}
+
+void MainWindow::appendToLog(int index, QString data, qint64 received)
+{
+    // Remember the block the message starts at so the timeline can jump
+    // back to it. The anchor goes in the slot the message was counted in,
+    // not the one it is rendered in.
+    QTextEdit *log = this->logEdit(index);
+    QTextDocument *document = log->document();
+    int block = document->isEmpty() ? 0 : document->blockCount();
+
+    this->rateHistory.setAnchor(received, index, block, this->logGeneration);
+
     // Append data to UI
     data = this->formatData(data);
+    log->append(data);
 
-    switch (index)
+    // Update message count
+    ++this->logCount[index];
+}
+
+void MainWindow::slFlushLanes()
+{
+    QVector<PendingMessage> messages = this->lanes.takeAll();
+    if (!messages.isEmpty())
     {
-        case 0: ui->uiLog1->append(data); break;
-        case 1: ui->uiLog2->append(data); break;
-        case 2: ui->uiLog3->append(data); break;
-        case 3: ui->uiLog4->append(data); break;
-        case 4: ui->uiLog5->append(data); break;
+        // Group the whole batch in one edit block per log, so each document
+        // is laid out once instead of once per message
+        QTextCursor batch[DATAGRAM_LOGS];
+        bool atBottom[DATAGRAM_LOGS];
+        for (int x = 0; x < DATAGRAM_LOGS; ++x)
+        {
+            QScrollBar *bar = this->logEdit(x)->verticalScrollBar();
+            atBottom[x] = (bar->value() == bar->maximum());
+
+            batch[x] = QTextCursor(this->logEdit(x)->document());
+            batch[x].beginEditBlock();
+        }
+
+        int count = messages.count();
+        for (int x = 0; x < count; ++x)
+        {
+            const PendingMessage &message = messages.at(x);
+            this->appendToLog(message.tab, message.data, message.received);
+        }
+
+        for (int x = 0; x < DATAGRAM_LOGS; ++x)
+        {
+            batch[x].endEditBlock();
+
+            // Keep following the log as append() does
+            QScrollBar *bar = this->logEdit(x)->verticalScrollBar();
+            if (atBottom[x])
+                bar->setValue(bar->maximum());
+        }
+
+        this->setTabCaptions();
     }
 
-    // Update message count and tab captions
-    ++this->logCount[index];
-    this->setTabCaptions();
+    this->updateShedStatus();
+}
+
+void MainWindow::countWatchHits(int index)
+{
+    foreach (const KeywordMatch &match, this->watchMatches)
+        ++this->watchCounts[match.pattern];
+    ++this->watchHits;
+    this->updateWatchStatus();
+
+    // First hit in a while alerts right away, later ones are summed up
+    if (this->watchTimer->isActive())
+    {
+        ++this->watchPending;
+        return;
+    }
+
+    QString pattern = this->watchlist.pattern(
+                                        this->watchMatches.first().pattern);
+    QString caption = this->tabCaptions.value(index).remove('&');
+    this->watchAlert(tr("\"%1\" found in %2").arg(pattern).arg(caption));
+    this->watchTimer->start(WATCH_ALERT_INTERVAL);
+}
+
+void MainWindow::slWatchTimeout()
+{
+    if (this->watchPending == 0)
+        return;
+
+    this->watchAlert(tr("%n more watched message(s)", "",
+                        this->watchPending));
+    this->watchPending = 0;
+    this->watchTimer->start(WATCH_ALERT_INTERVAL);
+}
+
+void MainWindow::watchAlert(const QString &message)
+{
+    QApplication::alert(this);
+
+    if (!this->watchAlerts || !QSystemTrayIcon::supportsMessages())
+        return;
+
+    if (this->trayIcon == NULL)
+    {
+        this->trayIcon = new QSystemTrayIcon(this->windowIcon(), this);
+        this->trayIcon->setToolTip(this->windowTitle());
+        this->trayIcon->show();
+    }
+
+    this->trayIcon->showMessage(tr("Maurina watchlist"), message,
+                                QSystemTrayIcon::Warning);
+}
+
+void MainWindow::updateWatchStatus()
+{
+    ui->uiWatchText->setVisible(this->watchHits > 0);
+    if (this->watchHits == 0)
+        return;
+
+    ui->uiWatchText->setText(tr("(%1 watched messages)")
+                             .arg(this->watchHits));
+
+    // Tooltip lists the patterns found, most frequent first
+    QList<QPair<quint64, int> > found;
+    for (int x = 0; x < this->watchCounts.size(); ++x)
+    {
+        if (this->watchCounts.at(x) > 0)
+            found << qMakePair(this->watchCounts.at(x), x);
+    }
+    std::sort(found.begin(), found.end());
+
+    QStringList lines;
+    for (int x = found.count() - 1; x >= 0 && lines.count() < 20; --x)
+    {
+        lines << tr("%1: %2").arg(this->watchlist.pattern(found.at(x).second))
+                             .arg(found.at(x).first);
+    }
+    ui->uiWatchText->setToolTip(lines.join("\n"));
+}
+
+void MainWindow::updateShedStatus()
+{
+    quint64 shed = this->lanes.totalShed();
+    ui->uiShedText->setVisible(shed > 0);
+    if (shed == 0)
+        return;
+
+    ui->uiShedText->setText(tr("(%1 messages shed)").arg(shed));
+    ui->uiShedText->setToolTip(tr("Normal lane: %1\nBulk lane: %2")
+                               .arg(this->lanes.shedCount(NormalLane))
+                               .arg(this->lanes.shedCount(BulkLane)));
 }
 
 void MainWindow::loadConfig()
@@ -252,111 +872,167 @@ void MainWindow::loadConfig()
     QRect windowGeometry(50, 50, 700, 400);
 
     // Load and parse config file if exists
-    bool configExists = QFile(this->userFolder + CONFIG_FILE).exists();
-    if (configExists)
-    {
-        QFile file(this->userFolder + CONFIG_FILE);
-        if (file.open(QFile::ReadOnly | QIODevice::Text))
-        {
-            QTextStream in(&file);
-            QString data("");
-            while (!in.atEnd())
-            {
-                QString line(in.readLine().trimmed());
-
-                if (line.startsWith("#") || line.isEmpty())
-                    continue;
-
-                QStringList parts = line.split("=");
-                if (parts.count() != 2)
-                    continue;
-                QString key = parts.at(0).trimmed().toLower();
-                QString value = parts.at(1).trimmed();
-
-                if (key == "serverip")
-                    this->serverIp.setAddress(value);
-                if (key == "serverport")
-                    this->serverPort = value.toInt();
-                if (key == "timeoutvalue")
-                    this->timeoutValue = value.toInt();
-                if (key == "timeoutenabled")
-                    this->timeoutEnabled = (value == "1") ? true : false;
-                if (key == "windowx")
-                    windowGeometry.setX(value.toInt());
-                if (key == "windowy")
-                    windowGeometry.setY(value.toInt());
-                if (key == "windoww")
-                    windowGeometry.setWidth(value.toInt());
-                if (key == "windowh")
-                    windowGeometry.setHeight(value.toInt());
-                if (key == "tab1caption")
-                    this->tabCaptions[0] = value;
-                if (key == "tab2caption")
-                    this->tabCaptions[1] = value;
-                if (key == "tab3caption")
-                    this->tabCaptions[2] = value;
-                if (key == "tab4caption")
-                    this->tabCaptions[3] = value;
-                if (key == "tab5caption")
-                    this->tabCaptions[4] = value;
-                if (key == "controlsvisible")
-                    this->controlsVisible = (value == "1") ? true : false;
-                if (key == "layout")
-                    this->layoutType = (LayoutType) value.toInt();
-            }
-            file.close();
-        }
-    }
+    this->configData = this->readFile(CONFIG_FILE);
+    this->configValues = readSettings(this->configData);
+    this->applySettings(this->configValues, &windowGeometry);
 
     // Load and parse styles file if exists
-    bool stylesExists = QFile(this->userFolder + STYLES_FILE).exists();
-    if (stylesExists)
+    this->stylesData = this->readFile(STYLES_FILE);
+    QHash<QString, QString> styleValues = readSettings(this->stylesData);
+    foreach (QString key, styleValues.keys())
+        this->styles[key] = styleValues.value(key);
+    this->compileStyles();
+
+    // Apply geometry values
+    this->setGeometry(windowGeometry);
+}
+
+QByteArray MainWindow::readFile(const QString &name)
+{
+    QFile file(this->userFolder + name);
+    if (!file.open(QFile::ReadOnly | QIODevice::Text))
+        return QByteArray();
+
+    return file.readAll();
+}
+
+QHash<QString, QString> MainWindow::readSettings(const QByteArray &data)
+{
+    // Config and styles files share the same "key = value" format. Keys are
+    // not case sensitive.
+    QHash<QString, QString> values;
+
+    QTextStream in(data);
+    while (!in.atEnd())
     {
-        QFile file(this->userFolder + STYLES_FILE);
-        if (file.open(QFile::ReadOnly | QIODevice::Text))
-        {
-            QTextStream in(&file);
-            QString data("");
-            while (!in.atEnd())
-            {
-                QString line(in.readLine().trimmed());
+        QString line(in.readLine().trimmed());
 
-                if (line.startsWith("#") || line.isEmpty())
-                    continue;
+        if (line.startsWith("#") || line.isEmpty())
+            continue;
 
-                QStringList parts = line.split("=");
-                if (parts.count() != 2)
-                    continue;
-                QString key = parts.at(0).trimmed().toLower();
-                QString value = parts.at(1).trimmed();
+        QStringList parts = line.split("=");
+        if (parts.count() != 2)
+            continue;
 
-                this->styles[key] = value;
-            }
-            file.close();
-        }
+        values.insert(parts.at(0).trimmed().toLower(), parts.at(1).trimmed());
     }
 
-    // Apply geometry values
-    this->setGeometry(windowGeometry);
+    return values;
+}
+
+void MainWindow::applySettings(const QHash<QString, QString> &values,
+                               QRect *windowGeometry)
+{
+    QHashIterator<QString, QString> it(values);
+    while (it.hasNext())
+    {
+        it.next();
+        const QString &key = it.key();
+        const QString &value = it.value();
+
+        if (key == "serverip")
+            this->serverIp.setAddress(value);
+        if (key == "serverport")
+            this->serverPort = value.toInt();
+        if (key == "relayip")
+            this->relayIp.setAddress(value);
+        if (key == "relayport")
+            this->relayPort = value.toInt();
+        if (key == "timeoutvalue")
+            this->timeoutValue = value.toInt();
+        if (key == "timeoutenabled")
+            this->timeoutEnabled = (value == "1") ? true : false;
+        if (key == "windowx")
+            windowGeometry->moveLeft(value.toInt());
+        if (key == "windowy")
+            windowGeometry->moveTop(value.toInt());
+        if (key == "windoww")
+            windowGeometry->setWidth(value.toInt());
+        if (key == "windowh")
+            windowGeometry->setHeight(value.toInt());
+        if (key == "tab1caption")
+            this->tabCaptions[0] = value;
+        if (key == "tab2caption")
+            this->tabCaptions[1] = value;
+        if (key == "tab3caption")
+            this->tabCaptions[2] = value;
+        if (key == "tab4caption")
+            this->tabCaptions[3] = value;
+        if (key == "tab5caption")
+            this->tabCaptions[4] = value;
+
+        // Captions the connector sends next must replace these even if
+        // they are the ones it sent last
+        if (key.startsWith("tab") && key.endsWith("caption"))
+            this->lastTabs.clear();
+
+        if (key == "controlsvisible")
+            this->controlsVisible = (value == "1") ? true : false;
+        if (key == "layout")
+            this->layoutType = (LayoutType) value.toInt();
+        if (key == "timelinevisible")
+            this->timelineVisible = (value == "1") ? true : false;
+        if (key == "batchinterval")
+            this->batchInterval = qMax(1, value.toInt());
+        if (key == "normalpolicy")
+            this->lanes.setPolicy(NormalLane,
+                            MessageLanes::policyFromName(value));
+        if (key == "bulkpolicy")
+            this->lanes.setPolicy(BulkLane,
+                            MessageLanes::policyFromName(value));
+        if (key == "normalbudget")
+            this->lanes.setBudget(NormalLane, value.toInt());
+        if (key == "bulkbudget")
+            this->lanes.setBudget(BulkLane, value.toInt());
+        if (key == "samplerate")
+            this->lanes.setSampleRate(value.toInt());
+        if (key == "historyenabled")
+            this->historyEnabled = (value == "1") ? true : false;
+        if (key == "historylimit")
+            this->historyLimit = value.toLongLong();
+        if (key == "watchalerts")
+            this->watchAlerts = (value == "1") ? true : false;
+    }
 }
 
 void MainWindow::saveConfig()
 {
+    // Files edited by hand and not reloaded yet would be overwritten, so
+    // their changes are applied first
+    if (this->configWatcher != NULL)
+    {
+        this->reloadTimer->stop();
+        this->slReloadConfig();
+    }
+
     QFile configFile(this->userFolder + CONFIG_FILE);
     if (configFile.open(QIODevice::WriteOnly))
     {
         QString data("# Maurina config file.\n"
                      "# Default values:\n# serverIp = 127.0.0.1\n"
-                     "# serverPort = 1947\n# timeoutEnabled = 1\n"
+                     "# serverPort = 1947\n# relayIp = 127.0.0.1\n"
+                     "# relayPort = 0 (relay connections disabled)\n"
+                     "# Relay connections are not authenticated, only set\n"
+                     "# relayIp to an interface trusted nodes alone reach.\n"
+                     "# timeoutEnabled = 1\n"
                      "# timeoutValue = 2\n# windowX = 50\n"
                      "# windowY = 50\n# windowW = 700\n# windowH = 400\n"
                      "# tab1caption = Log 1\n# tab2caption = Log 2\n"
                      "# tab3caption = Log 3\n# tab4caption = Log 4\n"
                      "# tab5caption = Log 5\n# controlsVisible = 1\n"
-                     "# layout = 0\n\n");
+                     "# layout = 0\n# timelineVisible = 1\n"
+                     "# batchInterval = 100\n# normalPolicy = batch\n"
+                     "# normalBudget = 1000\n# bulkPolicy = sample\n"
+                     "# bulkBudget = 1000\n# sampleRate = 10\n"
+                     "# historyEnabled = 1\n# historyLimit = 5000000\n"
+                     "# watchAlerts = 1\n"
+                     "# Lane policies: batch, sample or shed. Lanes shed\n"
+                     "# anything past 10 times their budget.\n\n");
 
         data += "serverIp = " + this->serverIp.toString() + "\n";
         data += "serverPort = " + QString::number(this->serverPort)+"\n";
+        data += "relayIp = " + this->relayIp.toString() + "\n";
+        data += "relayPort = " + QString::number(this->relayPort) + "\n";
         data += "timeoutEnabled = ";
         data += (this->timeoutEnabled) ? "1" : "0";
         data += "\ntimeoutValue = " + QString::number(this->timeoutValue)+"\n";
@@ -378,6 +1054,23 @@ void MainWindow::saveConfig()
         data += (this->controlsVisible) ? "1" : "0";
         data += "\nlayout = ";
         data += QString::number(this->layoutType);
+        data += "\ntimelineVisible = ";
+        data += (this->timelineVisible) ? "1" : "0";
+        data += "\nbatchInterval = " + QString::number(this->batchInterval);
+        data += "\nnormalPolicy = " +
+                MessageLanes::policyName(this->lanes.policy(NormalLane));
+        data += "\nnormalBudget = " +
+                QString::number(this->lanes.budget(NormalLane));
+        data += "\nbulkPolicy = " +
+                MessageLanes::policyName(this->lanes.policy(BulkLane));
+        data += "\nbulkBudget = " +
+                QString::number(this->lanes.budget(BulkLane));
+        data += "\nsampleRate = " + QString::number(this->lanes.sampleRate());
+        data += "\nhistoryEnabled = ";
+        data += (this->historyEnabled) ? "1" : "0";
+        data += "\nhistoryLimit = " + QString::number(this->historyLimit);
+        data += "\nwatchAlerts = ";
+        data += (this->watchAlerts) ? "1" : "0";
 
         QTextStream out(&configFile);
         out << data;
@@ -400,6 +1093,12 @@ void MainWindow::saveConfig()
         out << data;
         stylesFile.close();
     }
+
+    // What was just written is what the next reload compares against, so
+    // our own writes are not taken as user edits
+    this->configData = this->readFile(CONFIG_FILE);
+    this->configValues = readSettings(this->configData);
+    this->stylesData = this->readFile(STYLES_FILE);
 }
 
 void MainWindow::slToggleControls()
@@ -413,6 +1112,8 @@ void MainWindow::updateControls()
 {
     ui->frameControls1->setVisible(this->controlsVisible);
     ui->frameControls2->setVisible(this->controlsVisible);
+    ui->uiTimeline->setVisible(this->controlsVisible &&
+                               this->timelineVisible);
     ui->menuBar->setVisible(this->controlsVisible);
 
     // If menu bar is hidden the actions are also hidden, and
@@ -445,6 +1146,21 @@ void MainWindow::updateControls()
         connect(this->scPreferences, SIGNAL(activated()),
                 this,                SLOT(slShowPreferences()));
 
+        this->scTimeline = new QShortcut(QKeySequence(tr("Ctrl+T")), this);
+        this->scTimeline->setContext(Qt::ApplicationShortcut);
+        connect(this->scTimeline, SIGNAL(activated()),
+                this,             SLOT(slToggleTimeline()));
+
+        this->scHistory = new QShortcut(QKeySequence(tr("Ctrl+F")), this);
+        this->scHistory->setContext(Qt::ApplicationShortcut);
+        connect(this->scHistory, SIGNAL(activated()),
+                this,            SLOT(slShowHistory()));
+
+        this->scProfiler = new QShortcut(QKeySequence(tr("Ctrl+R")), this);
+        this->scProfiler->setContext(Qt::ApplicationShortcut);
+        connect(this->scProfiler, SIGNAL(activated()),
+                this,             SLOT(slShowProfiler()));
+
         // We also remove all margins for the central widget
         ui->centralWidget->layout()->setContentsMargins(0, 0, 0, 0);
     }
@@ -476,6 +1192,21 @@ void MainWindow::updateControls()
             delete this->scPreferences;
             this->scPreferences = NULL;
         }
+        if (this->scTimeline != NULL)
+        {
+            delete this->scTimeline;
+            this->scTimeline = NULL;
+        }
+        if (this->scHistory != NULL)
+        {
+            delete this->scHistory;
+            this->scHistory = NULL;
+        }
+        if (this->scProfiler != NULL)
+        {
+            delete this->scProfiler;
+            this->scProfiler = NULL;
+        }
 
         // And restore the central widget margins
         ui->centralWidget->layout()->setContentsMargins(9, 9, 9, 9);
@@ -500,6 +1231,7 @@ void MainWindow::updateLayout()
         ui->frameCompactLayoutTop->show();
         ui->frameCompactLayoutBottom->show();
         ui->tabWidget->hide();
+        ui->uiTimeline->setTab(-1);
 
         // Move tabs to bottom widgets
         ui->tabWidgetA->addTab(ui->tabWidget->widget(0), "");
@@ -526,6 +1258,7 @@ void MainWindow::updateLayout()
         ui->frameCompactLayoutTop->hide();
         ui->frameCompactLayoutBottom->hide();
         ui->tabWidget->show();
+        ui->uiTimeline->setTab(ui->tabWidget->currentIndex());
     }
 
     this->setTabCaptions();
@@ -571,21 +1304,14 @@ void MainWindow::setTabCaption(int index, QString caption)
 
 QString MainWindow::formatData(QString data)
 {
-    foreach(QString key, this->styles.keys())
-    {
-        QString openTag("<" + key + ">");
-        QString closeTag("</" + key + ">");
-        QString value(this->styles[key].replace('"', "'"));
-        QString newOpenTag("<span style=\"" + value + "\">");
-        QString newCloseTag("</span>");
-        if (key == "pre")
-        {
-            newOpenTag = "<pre style=\"" + value + "\">";
-            newCloseTag = "</pre>";
-        }
+    // Messages without tags have nothing to style
+    if (!data.contains('<'))
+        return data;
 
-        data = data.replace(openTag, newOpenTag, Qt::CaseInsensitive);
-        data = data.replace(closeTag, newCloseTag, Qt::CaseInsensitive);
+    foreach (const StyleTag &tag, this->styleTags)
+    {
+        data.replace(tag.openTag, tag.newOpenTag, Qt::CaseInsensitive);
+        data.replace(tag.closeTag, tag.newCloseTag, Qt::CaseInsensitive);
     }
 
     return data;
@@ -601,10 +1327,146 @@ void MainWindow::slShowPreferences()
 
     if (config.exec() == QDialog::Accepted)
     {
-        this->serverIp = config.getServerAddress();
-        this->serverPort = config.getServerPort();
+        // Logs are kept, and the socket is only replaced if the address
+        // changed
+        QHostAddress serverIp = config.getServerAddress();
+        quint16 serverPort = config.getServerPort();
+        bool rebind = (serverIp != this->serverIp ||
+                       serverPort != this->serverPort);
+
+        this->serverIp = serverIp;
+        this->serverPort = serverPort;
         this->styles = config.getStyles();
+        this->compileStyles();
+        this->updateTimelineColors();
+
+        // A failed bind restores the address in use before it's saved
+        if (rebind)
+            this->bindServer();
         this->saveConfig();
-        this->startServer();
     }
 }
+
+void MainWindow::slToggleTimeline()
+{
+    this->timelineVisible = !this->timelineVisible;
+    ui->actionShowTimeline->setChecked(this->timelineVisible);
+    this->saveConfig();
+    this->updateControls();
+}
+
+void MainWindow::slTabChanged(int index)
+{
+    if (this->layoutType == DetailedLayout)
+        ui->uiTimeline->setTab(index);
+}
+
+void MainWindow::slJumpToTime(int tab, qint64 from, qint64 to)
+{
+    int block = this->rateHistory.anchor(from, to, tab, this->logGeneration);
+    QTextEdit *log = this->logEdit(tab);
+    QTextBlock target = log->document()->findBlockByNumber(block);
+    if (block < 0 || !target.isValid())
+    {
+        QToolTip::showText(QCursor::pos(),
+                           tr("Messages from that moment are no longer "
+                              "in the log"));
+        return;
+    }
+
+    if (this->layoutType == DetailedLayout)
+        ui->tabWidget->setCurrentIndex(tab);
+
+    // Select the first message and scroll so it shows at the top
+    QTextCursor cursor(target);
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    log->verticalScrollBar()->setValue(log->verticalScrollBar()->maximum());
+    log->setTextCursor(cursor);
+    log->ensureCursorVisible();
+    log->setFocus();
+}
+
+void MainWindow::updateTimelineColors()
+{
+    // Plot each level with the color used to display it
+    QRegExp colorRule("color\\s*:\\s*([^;]+)", Qt::CaseInsensitive);
+    for (int level = 1; level < RATE_LEVELS; ++level)
+    {
+        QString style = this->styles.value("h" + QString::number(level));
+        if (colorRule.indexIn(style) >= 0)
+            ui->uiTimeline->setLevelColor(level,
+                                          QColor(colorRule.cap(1).trimmed()));
+    }
+}
+
+QTextEdit *MainWindow::logEdit(int index)
+{
+    switch (index)
+    {
+        case 1: return ui->uiLog2;
+        case 2: return ui->uiLog3;
+        case 3: return ui->uiLog4;
+        case 4: return ui->uiLog5;
+    }
+
+    return ui->uiLog1;
+}
+
+int MainWindow::messageLevel(const QString &data)
+{
+    // Most important <hN> tag found in the message, 0 if there's none
+    int level = 0;
+    const QChar *c = data.constData();
+    int length = data.length() - 2;
+    for (int x = 0; x < length; ++x)
+    {
+        if (c[x] != '<' || (c[x + 1] != 'h' && c[x + 1] != 'H'))
+            continue;
+
+        ushort digit = c[x + 2].unicode();
+        if (digit < '1' || digit > '6')
+            continue;
+
+        if (level == 0 || digit - '0' < level)
+            level = digit - '0';
+        if (level == 1)
+            break;
+    }
+
+    return level;
+}
+
+void MainWindow::addSpans()
+{
+    for (int x = 0; x < this->decoder.spanCount(); ++x)
+    {
+        const DatagramSpan &span = this->decoder.span(x);
+        this->spans.add(span.name.toString(), span.id.toString(),
+                        span.parent.toString(), span.start, span.duration);
+    }
+}
+
+void MainWindow::slShowProfiler()
+{
+    if (this->profilerDialog == NULL)
+        this->profilerDialog = new profilerWindow(&this->spans, this);
+    else this->profilerDialog->refresh();
+
+    this->profilerDialog->show();
+    this->profilerDialog->raise();
+    this->profilerDialog->activateWindow();
+}
+
+void MainWindow::slShowHistory()
+{
+    if (!this->history->isOpen())
+        return;
+
+    if (this->historyDialog == NULL)
+        this->historyDialog = new historyWindow(this->history, this);
+
+    this->historyDialog->setTabCaptions(this->tabCaptions);
+    this->historyDialog->show();
+    this->historyDialog->raise();
+    this->historyDialog->activateWindow();
+}
@@ -6,19 +6,46 @@
 #include <QProcess>
 #include <QFile>
 #include <QDir>
-#include <QJsonDocument>
 #include <QTimer>
 #include <QLabel>
 #include <QTranslator>
 #include <QShortcut>
+#include <QTextEdit>
+#include <QTextBlock>
+#include <QScrollBar>
+#include <QToolTip>
+#include <QDateTime>
+#include <QRegExp>
+#include <QSystemTrayIcon>
+#include <QFileSystemWatcher>
 
 #include "aboutWindow.h"
 #include "configWindow.h"
+#include "RateHistory.h"
+#include "DatagramDecoder.h"
+#include "MessageLanes.h"
+#include "HistoryStore.h"
+#include "historyWindow.h"
+#include "SpanAggregator.h"
+#include "profilerWindow.h"
+#include "RelayServer.h"
+#include "KeywordMatcher.h"
 
 #define CONFIG_FILE "config"
 #define STYLES_FILE "styles"
+#define WATCHLIST_FILE "watchlist"
+#define HISTORY_FOLDER "history"
 #define VERSION "1.2"
 
+// Datagrams read in a row before letting the event loop render batches
+#define MAX_DATAGRAMS_PER_READ 1000
+
+// Minimum time between watchlist alerts, in ms
+#define WATCH_ALERT_INTERVAL 5000
+
+// Time config files must stay unchanged before being reloaded, in ms
+#define RELOAD_DELAY 250
+
 namespace Ui
 {
 class MainWindow;
@@ -33,19 +60,42 @@ enum LayoutType
     CompactLayout  = 1,	/**< All tabs visible	*/
 };
 
+/**
+* Replacements of a styled tag, built once when styles change
+*/
+struct StyleTag
+{
+    QString openTag;
+    QString closeTag;
+    QString newOpenTag;
+    QString newCloseTag;
+};
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
+    friend class MaurinaBenchmarks;
+
 private slots:
     void slPendingDatagrams();
+    void slRelayBatch(const QByteArray &batch);
+    void slWatchTimeout();
+    void slConfigFileChanged();
+    void slReloadConfig();
     void slTimeoutChanged(int state);
     void slClearTimeout();
+    void slFlushLanes();
+    void slShowHistory();
+    void slShowProfiler();
     void slClearLogs();
     void slShowAbout();
     void slShowPreferences();
     void slToggleControls();
     void slChangeLayout();
+    void slToggleTimeline();
+    void slTabChanged(int index);
+    void slJumpToTime(int tab, qint64 from, qint64 to);
     
 public:
     explicit MainWindow(QWidget *parent = 0);
@@ -60,23 +110,80 @@ private:
     bool timeoutEnabled;
     int timeoutValue;
     QUdpSocket *server;
+    QHostAddress relayIp;
+    quint16 relayPort;
+    RelayServer *relayServer;
+    QByteArray datagramBuffer;
+    DatagramDecoder decoder;
+    QByteArray lastTabs;
     QTimer *clearTimer;
     bool resetLogs;
     QVector<int> logCount;
     QStringList tabCaptions;
     bool controlsVisible;
     QShortcut *scControls, *scAbout, *scLayout, *scExit, *scPreferences;
+    QShortcut *scTimeline, *scHistory, *scProfiler;
     LayoutType layoutType;
-    QHash<QString, QString> styles;
+    QHash<QString, QString> styles, defaultStyles;
+    QVector<StyleTag> styleTags;
+    QString serverError;
+    QFileSystemWatcher *configWatcher;
+    QTimer *reloadTimer;
+    QByteArray configData, stylesData, watchlistData;
+    QHash<QString, QString> configValues;
+    bool timelineVisible;
+    RateHistory rateHistory;
+    quint32 logGeneration;
+    MessageLanes lanes;
+    QTimer *flushTimer;
+    int batchInterval;
+    HistoryStore *history;
+    historyWindow *historyDialog;
+    bool historyEnabled;
+    qint64 historyLimit;
+    SpanAggregator spans;
+    profilerWindow *profilerDialog;
+    KeywordMatcher watchlist;
+    QVector<KeywordMatch> watchMatches;
+    QVector<quint64> watchCounts;
+    quint64 watchHits;
+    int watchPending;
+    bool watchAlerts;
+    QTimer *watchTimer;
+    QSystemTrayIcon *trayIcon;
 
     void loadConfig();
     void saveConfig();
-    void startServer();
+    void loadWatchlist();
+    QByteArray readFile(const QString &name);
+    static QHash<QString, QString> readSettings(const QByteArray &data);
+    void applySettings(const QHash<QString, QString> &values,
+                       QRect *windowGeometry);
+    void reloadConfig(const QHash<QString, QString> &values);
+    void reloadStyles(const QHash<QString, QString> &values);
+    void watchConfigFiles();
+    void compileStyles();
+    bool bindServer();
+    void closeServer();
+    bool readDatagrams(QUdpSocket *socket, int max);
+    void startRelay();
+    void updateServerStatus();
+    void processDatagram(const QByteArray &datagram,
+                         const QString &source = QString());
+    void addSpans();
     void addDataToLog(int index, QString data);
+    void appendToLog(int index, QString data, qint64 received);
+    void updateShedStatus();
+    void countWatchHits(int index);
+    void updateWatchStatus();
+    void watchAlert(const QString &message);
     void setTabCaptions();
     void setTabCaption(int index, QString caption);
     void updateControls();
     void updateLayout();
+    void updateTimelineColors();
+    QTextEdit *logEdit(int index);
+    int messageLevel(const QString &data);
     QString formatData(QString data);
 };
 
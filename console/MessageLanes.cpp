@@ -0,0 +1,128 @@
+#include "MessageLanes.h"
+
+MessageLanes::MessageLanes() :
+    sampling(10)
+{
+    for (int x = 0; x < LANE_COUNT; ++x)
+    {
+        this->pendingCount[x] = 0;
+        this->policies[x] = BatchPolicy;
+        this->budgets[x] = 1000;
+        this->overBudget[x] = 0;
+        this->shed[x] = 0;
+    }
+    this->policies[BulkLane] = SamplePolicy;
+}
+
+Lane MessageLanes::laneFor(int level)
+{
+    if (level == 1)
+        return HighLane;
+    if (level == 2 || level == 3)
+        return NormalLane;
+
+    return BulkLane;
+}
+
+LanePolicy MessageLanes::policyFromName(const QString &name)
+{
+    QString policy = name.trimmed().toLower();
+    if (policy == "sample")
+        return SamplePolicy;
+    if (policy == "shed")
+        return ShedPolicy;
+
+    return BatchPolicy;
+}
+
+QString MessageLanes::policyName(LanePolicy policy)
+{
+    switch (policy)
+    {
+        case SamplePolicy: return "sample";
+        case ShedPolicy:   return "shed";
+        default:           return "batch";
+    }
+}
+
+void MessageLanes::setPolicy(Lane lane, LanePolicy policy)
+{
+    this->policies[lane] = policy;
+}
+
+void MessageLanes::setBudget(Lane lane, int messages)
+{
+    this->budgets[lane] = qMax(1, messages);
+}
+
+void MessageLanes::setSampleRate(int rate)
+{
+    this->sampling = qMax(1, rate);
+}
+
+bool MessageLanes::enqueue(Lane lane, int tab, qint64 received,
+                           const QString &data)
+{
+    // Hard cap, whatever the policy
+    if (this->pendingCount[lane] >= (qint64) this->budgets[lane] *
+                                    LANE_CAP_FACTOR)
+    {
+        ++this->shed[lane];
+        return false;
+    }
+
+    // Apply the lane policy once its budget is used up
+    if (this->pendingCount[lane] >= this->budgets[lane])
+    {
+        bool keep = true;
+        if (this->policies[lane] == ShedPolicy)
+            keep = false;
+        else if (this->policies[lane] == SamplePolicy)
+            keep = (this->overBudget[lane]++ % this->sampling) == 0;
+
+        if (!keep)
+        {
+            ++this->shed[lane];
+            return false;
+        }
+    }
+
+    PendingMessage message;
+    message.tab = tab;
+    message.received = received;
+    message.data = data;
+    this->pending.append(message);
+    ++this->pendingCount[lane];
+
+    return true;
+}
+
+QVector<PendingMessage> MessageLanes::takeAll()
+{
+    QVector<PendingMessage> messages;
+    messages.swap(this->pending);
+
+    for (int x = 0; x < LANE_COUNT; ++x)
+    {
+        this->pendingCount[x] = 0;
+        this->overBudget[x] = 0;
+    }
+
+    return messages;
+}
+
+void MessageLanes::clear()
+{
+    this->takeAll();
+    for (int x = 0; x < LANE_COUNT; ++x)
+        this->shed[x] = 0;
+}
+
+quint64 MessageLanes::totalShed() const
+{
+    quint64 total = 0;
+    for (int x = 0; x < LANE_COUNT; ++x)
+        total += this->shed[x];
+
+    return total;
+}
@@ -0,0 +1,83 @@
+#ifndef MESSAGELANES_H
+#define MESSAGELANES_H
+
+#include <QString>
+#include <QVector>
+
+/**
+* Priority lanes. Messages are classified by level (explicit level field or
+* most important <hN> tag): level 1 goes to the high lane, levels 2 and 3 to
+* the normal lane and anything else to the bulk lane.
+*/
+enum Lane
+{
+    HighLane   = 0, /**< Rendered as soon as received  */
+    NormalLane = 1, /**< Batched                       */
+    BulkLane   = 2, /**< Batched, first one to be shed */
+};
+
+#define LANE_COUNT 3
+
+// Pending messages a lane may hold, as a multiple of its budget, whatever its
+// policy. Past this messages are shed so a stalled flush can't grow the queue
+// without limit.
+#define LANE_CAP_FACTOR 10
+
+/**
+* What a batched lane does when it has more pending messages than its budget
+*/
+enum LanePolicy
+{
+    BatchPolicy  = 0, /**< Keep everything up to cap  */
+    SamplePolicy = 1, /**< Keep one of every N        */
+    ShedPolicy   = 2, /**< Drop messages over budget  */
+};
+
+/**
+* Message waiting to be rendered
+*/
+struct PendingMessage
+{
+    int tab;
+    qint64 received; /**< Arrival time (seconds) */
+    QString data;
+};
+
+/**
+* Queue of messages from the batched lanes, kept in arrival order
+*/
+class MessageLanes
+{
+public:
+    MessageLanes();
+
+    static Lane laneFor(int level);
+    static LanePolicy policyFromName(const QString &name);
+    static QString policyName(LanePolicy policy);
+
+    LanePolicy policy(Lane lane) const { return this->policies[lane]; }
+    int budget(Lane lane) const { return this->budgets[lane]; }
+    int sampleRate() const { return this->sampling; }
+    void setPolicy(Lane lane, LanePolicy policy);
+    void setBudget(Lane lane, int messages);
+    void setSampleRate(int rate);
+
+    bool enqueue(Lane lane, int tab, qint64 received, const QString &data);
+    QVector<PendingMessage> takeAll();
+    bool isEmpty() const { return this->pending.isEmpty(); }
+    void clear();
+
+    quint64 shedCount(Lane lane) const { return this->shed[lane]; }
+    quint64 totalShed() const;
+
+private:
+    QVector<PendingMessage> pending;
+    int pendingCount[LANE_COUNT];
+    LanePolicy policies[LANE_COUNT];
+    int budgets[LANE_COUNT];
+    int sampling;
+    quint64 overBudget[LANE_COUNT];
+    quint64 shed[LANE_COUNT];
+};
+
+#endif // MESSAGELANES_H
@@ -0,0 +1,176 @@
+#include "RateHistory.h"
+
+#include <cstring>
+
+RateRing::RateRing(int resolution, int size) :
+    res(resolution), head(-1)
+{
+    this->buckets.resize(size);
+    this->clear();
+}
+
+qint64 RateRing::oldest() const
+{
+    if (this->head < 0)
+        return -1;
+
+    return this->head - (qint64) (this->buckets.size() - 1) * this->res;
+}
+
+void RateRing::clear()
+{
+    int size = this->buckets.size();
+    for (int x = 0; x < size; ++x)
+    {
+        RateBucket &bucket = this->buckets[x];
+        memset(&bucket, 0, sizeof(RateBucket));
+        bucket.start = -1;
+        for (int tab = 0; tab < RATE_TABS; ++tab)
+            bucket.anchor[tab] = -1;
+    }
+    this->head = -1;
+}
+
+int RateRing::indexOf(qint64 start) const
+{
+    return (int) ((start / this->res) % this->buckets.size());
+}
+
+RateBucket *RateRing::advance(qint64 second)
+{
+    qint64 start = second - second % this->res;
+
+    // Too old to be stored
+    if (this->head >= 0 && start < this->oldest())
+        return NULL;
+
+    // Recycle every bucket between the current head and the new one. If we
+    // skipped more than a full turn all of them are reset.
+    if (start > this->head)
+    {
+        qint64 from = this->head + this->res;
+        if (this->head < 0 || start - from >= (qint64) this->buckets.size() *
+                                                this->res)
+            from = start - (qint64) (this->buckets.size() - 1) * this->res;
+
+        for (qint64 slot = from; slot <= start; slot += this->res)
+        {
+            RateBucket &bucket = this->buckets[this->indexOf(slot)];
+            memset(&bucket, 0, sizeof(RateBucket));
+            bucket.start = slot;
+            for (int tab = 0; tab < RATE_TABS; ++tab)
+                bucket.anchor[tab] = -1;
+        }
+        this->head = start;
+    }
+
+    return &this->buckets[this->indexOf(start)];
+}
+
+void RateRing::add(qint64 second, int tab, int level)
+{
+    RateBucket *bucket = this->advance(second);
+    if (bucket != NULL)
+        ++bucket->count[tab][level];
+}
+
+void RateRing::setAnchor(qint64 second, int tab, int block,
+                         quint32 generation)
+{
+    RateBucket *bucket = this->advance(second);
+    if (bucket == NULL)
+        return;
+
+    // Anchors recorded before the logs were cleared point to blocks that
+    // no longer exist
+    if (bucket->generation != generation)
+    {
+        for (int x = 0; x < RATE_TABS; ++x)
+            bucket->anchor[x] = -1;
+        bucket->generation = generation;
+    }
+
+    if (bucket->anchor[tab] < 0)
+        bucket->anchor[tab] = block;
+}
+
+const RateBucket *RateRing::bucket(qint64 second) const
+{
+    if (this->head < 0)
+        return NULL;
+
+    qint64 start = second - second % this->res;
+    if (start > this->head || start < this->oldest())
+        return NULL;
+
+    const RateBucket &bucket = this->buckets.at(this->indexOf(start));
+    if (bucket.start != start)
+        return NULL;
+
+    return &bucket;
+}
+
+RateHistory::RateHistory()
+{
+    this->rings << RateRing(1, 3600)    // 1 hour at 1 s
+                << RateRing(10, 2160)   // 6 hours at 10 s
+                << RateRing(60, 1440);  // 24 hours at 1 min
+}
+
+const RateRing &RateHistory::ringFor(qint64 span, int maxBuckets) const
+{
+    // Finest ring that covers the whole span without drawing more buckets
+    // than requested
+    int count = this->rings.size();
+    for (int x = 0; x < count; ++x)
+    {
+        const RateRing &ring = this->rings.at(x);
+        if ((qint64) ring.size() * ring.resolution() >= span &&
+            span / ring.resolution() <= maxBuckets)
+            return ring;
+    }
+
+    return this->rings.last();
+}
+
+void RateHistory::addMessage(qint64 second, int tab, int level)
+{
+    int count = this->rings.size();
+    for (int x = 0; x < count; ++x)
+        this->rings[x].add(second, tab, level);
+}
+
+void RateHistory::setAnchor(qint64 second, int tab, int block,
+                            quint32 generation)
+{
+    int count = this->rings.size();
+    for (int x = 0; x < count; ++x)
+        this->rings[x].setAnchor(second, tab, block, generation);
+}
+
+int RateHistory::anchor(qint64 from, qint64 to, int tab,
+                        quint32 generation) const
+{
+    // Use the finest ring that still remembers that time range and return
+    // the first message logged in it
+    int count = this->rings.size();
+    for (int x = 0; x < count; ++x)
+    {
+        const RateRing &ring = this->rings.at(x);
+        if (ring.bucket(from) == NULL && ring.bucket(to - 1) == NULL)
+            continue;
+
+        qint64 first = from - from % ring.resolution();
+        for (qint64 slot = first; slot < to; slot += ring.resolution())
+        {
+            const RateBucket *bucket = ring.bucket(slot);
+            if (bucket == NULL || bucket->generation != generation)
+                continue;
+            if (bucket->anchor[tab] >= 0)
+                return bucket->anchor[tab];
+        }
+        return -1;
+    }
+
+    return -1;
+}
@@ -0,0 +1,69 @@
+#ifndef RATEHISTORY_H
+#define RATEHISTORY_H
+
+#include <QVector>
+
+#define RATE_TABS   5
+#define RATE_LEVELS 7
+
+/**
+* Pre-aggregated message counts for a fixed time slot
+*/
+struct RateBucket
+{
+    qint64 start;                           /**< Slot start (seconds)    */
+    quint32 count[RATE_TABS][RATE_LEVELS];  /**< Messages per tab/level  */
+    int anchor[RATE_TABS];                  /**< First log block in slot */
+    quint32 generation;                     /**< Log generation of anchors */
+};
+
+/**
+* Ring of buckets with a fixed resolution. Old buckets are recycled as time
+* advances so memory use never grows.
+*/
+class RateRing
+{
+public:
+    RateRing(int resolution = 1, int size = 1);
+
+    int resolution() const { return this->res; }
+    int size() const { return this->buckets.size(); }
+    qint64 newest() const { return this->head; }
+    qint64 oldest() const;
+
+    void add(qint64 second, int tab, int level);
+    void setAnchor(qint64 second, int tab, int block, quint32 generation);
+    const RateBucket *bucket(qint64 second) const;
+    void clear();
+
+private:
+    QVector<RateBucket> buckets;
+    int res;
+    qint64 head;
+
+    RateBucket *advance(qint64 second);
+    int indexOf(qint64 start) const;
+};
+
+/**
+* Message rate history. Each message is counted at 1 s, 10 s and 1 min
+* resolution so long time spans can be drawn without walking every second.
+*/
+class RateHistory
+{
+public:
+    RateHistory();
+
+    int ringCount() const { return this->rings.size(); }
+    const RateRing &ring(int index) const { return this->rings.at(index); }
+    const RateRing &ringFor(qint64 span, int maxBuckets) const;
+
+    void addMessage(qint64 second, int tab, int level);
+    void setAnchor(qint64 second, int tab, int block, quint32 generation);
+    int anchor(qint64 from, qint64 to, int tab, quint32 generation) const;
+
+private:
+    QVector<RateRing> rings;
+};
+
+#endif // RATEHISTORY_H
@@ -0,0 +1,68 @@
+#include "RelayBatch.h"
+
+#include <QtEndian>
+
+RelayBatch::RelayBatch(const QByteArray &batch) :
+    batch(batch),
+    offset(0),
+    valid(false)
+{
+    if (batch.size() < 2)
+        return;
+
+    const uchar *data = (const uchar *) batch.constData();
+    int size = qFromBigEndian<quint16>(data);
+    if (2 + size > batch.size())
+        return;
+
+    this->nodeName = QString::fromUtf8(batch.constData() + 2, size);
+    this->offset = 2 + size;
+    this->valid = true;
+}
+
+bool RelayBatch::next(QByteArray *datagram)
+{
+    if (!this->valid || this->offset + 4 > this->batch.size())
+        return false;
+
+    const char *data = this->batch.constData() + this->offset;
+    quint32 size = qFromBigEndian<quint32>((const uchar *) data);
+    if (size > (quint32) (this->batch.size() - this->offset - 4))
+    {
+        this->valid = false;
+        return false;
+    }
+
+    // Datagrams point into the batch, no bytes are copied
+    *datagram = QByteArray::fromRawData(data + 4, (int) size);
+    this->offset += 4 + (int) size;
+    return true;
+}
+
+QByteArray RelayBatch::header(const QString &node)
+{
+    QByteArray name = node.toUtf8().left(0xffff);
+
+    QByteArray header(2, 0);
+    qToBigEndian<quint16>((quint16) name.size(), (uchar *) header.data());
+    header += name;
+    return header;
+}
+
+void RelayBatch::append(QByteArray *batch, const char *data, int size)
+{
+    uchar length[4];
+    qToBigEndian<quint32>((quint32) size, length);
+    batch->append((const char *) length, 4);
+    batch->append(data, size);
+}
+
+QByteArray RelayBatch::frame(const QByteArray &batch)
+{
+    QByteArray compressed = qCompress(batch);
+
+    QByteArray frame(4, 0);
+    qToBigEndian<quint32>((quint32) compressed.size(), (uchar *) frame.data());
+    frame += compressed;
+    return frame;
+}
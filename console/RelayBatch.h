@@ -0,0 +1,43 @@
+#ifndef RELAYBATCH_H
+#define RELAYBATCH_H
+
+#include <QByteArray>
+#include <QString>
+
+// Relay connection tuning
+#define RELAY_FLUSH_INTERVAL     50             // ms a batch waits at most
+#define RELAY_MAX_BATCH          (64 * 1024)    // bytes that trigger a flush
+#define RELAY_MAX_FRAME          (16 << 20)     // largest frame accepted
+#define RELAY_MAX_INFLATED       (256 * 1024)   // largest batch unpacked
+#define RELAY_MAX_QUEUED         (16 << 20)     // bytes held while offline
+#define RELAY_RECONNECT_INTERVAL 1000           // ms between attempts
+
+/**
+* Batch of datagrams sent from a relay to the console. A batch starts with
+* the node name (quint16 size plus UTF-8 bytes) followed by the datagrams,
+* each one a quint32 size plus its bytes. Sizes are big endian.
+*
+* On the wire every batch is a frame: a big endian quint32 size followed by
+* the qCompress()ed batch.
+*/
+class RelayBatch
+{
+public:
+    explicit RelayBatch(const QByteArray &batch);
+
+    bool isValid() const { return this->valid; }
+    QString node() const { return this->nodeName; }
+    bool next(QByteArray *datagram);
+
+    static QByteArray header(const QString &node);
+    static void append(QByteArray *batch, const char *data, int size);
+    static QByteArray frame(const QByteArray &batch);
+
+private:
+    const QByteArray &batch;
+    int offset;
+    bool valid;
+    QString nodeName;
+};
+
+#endif // RELAYBATCH_H
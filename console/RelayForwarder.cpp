@@ -0,0 +1,155 @@
+#include "RelayForwarder.h"
+
+RelayForwarder::RelayForwarder(QObject *parent) :
+    QObject(parent),
+    listener(NULL), stream(NULL), flushTimer(NULL), reconnectTimer(NULL),
+    port(0), headerSize(0), queuedBytes(0), dropped(0)
+{
+}
+
+bool RelayForwarder::start(const QHostAddress &listenIp, quint16 listenPort,
+                           const QString &host, quint16 port,
+                           const QString &node)
+{
+    this->host = host;
+    this->port = port;
+
+    this->listener = new QUdpSocket(this);
+    if (!this->listener->bind(listenIp, listenPort))
+    {
+        qWarning("Relay bind failed at %s:%d: %s",
+                 qPrintable(listenIp.toString()), listenPort,
+                 qPrintable(this->listener->errorString()));
+        return false;
+    }
+
+    // Every batch starts with the node name. Capacity is reserved once so
+    // emptying the batch after a flush doesn't free it.
+    QByteArray header = RelayBatch::header(node);
+    this->headerSize = header.size();
+    this->batch.reserve(RELAY_MAX_BATCH * 2);
+    this->batch.append(header);
+
+    this->flushTimer = new QTimer(this);
+    this->flushTimer->setSingleShot(true);
+    this->reconnectTimer = new QTimer(this);
+    this->reconnectTimer->setSingleShot(true);
+    this->stream = new QTcpSocket(this);
+
+    connect(this->listener,         SIGNAL(readyRead()),
+            this,                   SLOT(slPendingDatagrams()));
+    connect(this->flushTimer,       SIGNAL(timeout()),
+            this,                   SLOT(slFlush()));
+    connect(this->reconnectTimer,   SIGNAL(timeout()),
+            this,                   SLOT(slConnect()));
+    connect(this->stream,           SIGNAL(connected()),
+            this,                   SLOT(slConnected()));
+    connect(this->stream,           SIGNAL(disconnected()),
+            this,                   SLOT(slDisconnected()));
+    connect(this->stream, SIGNAL(error(QAbstractSocket::SocketError)),
+            this,         SLOT(slError(QAbstractSocket::SocketError)));
+
+    qInfo("Relaying %s:%d to %s:%d as %s", qPrintable(listenIp.toString()),
+          listenPort, qPrintable(host), port, qPrintable(node));
+
+    this->slConnect();
+    return true;
+}
+
+void RelayForwarder::slPendingDatagrams()
+{
+    while (this->listener->hasPendingDatagrams())
+    {
+        this->datagramBuffer.resize(this->listener->pendingDatagramSize());
+        this->listener->readDatagram(this->datagramBuffer.data(),
+                                     this->datagramBuffer.size());
+
+        RelayBatch::append(&this->batch, this->datagramBuffer.constData(),
+                           this->datagramBuffer.size());
+
+        // Full batches go right away, the rest wait for the flush timer
+        if (this->batch.size() >= RELAY_MAX_BATCH)
+            this->slFlush();
+        else if (!this->flushTimer->isActive())
+            this->flushTimer->start(RELAY_FLUSH_INTERVAL);
+    }
+}
+
+void RelayForwarder::slFlush()
+{
+    this->flushTimer->stop();
+    if (this->batch.size() == this->headerSize)
+        return;
+
+    this->send(RelayBatch::frame(this->batch));
+    this->batch.truncate(this->headerSize);
+}
+
+void RelayForwarder::send(const QByteArray &frame)
+{
+    if (this->stream->state() == QAbstractSocket::ConnectedState &&
+        this->queued.isEmpty())
+    {
+        // A console that can't keep up must not make the relay grow forever
+        if (this->stream->bytesToWrite() > RELAY_MAX_QUEUED)
+            this->drop(1);
+        else this->stream->write(frame);
+        return;
+    }
+
+    // Hold batches while offline, dropping the oldest ones past the limit
+    this->queued.append(frame);
+    this->queuedBytes += frame.size();
+    while (this->queuedBytes > RELAY_MAX_QUEUED && this->queued.count() > 1)
+    {
+        this->queuedBytes -= this->queued.takeFirst().size();
+        this->drop(1);
+    }
+}
+
+void RelayForwarder::drop(int batches)
+{
+    if (this->dropped == 0)
+        qWarning("Console not reachable, dropping batches");
+
+    this->dropped += batches;
+}
+
+void RelayForwarder::slConnect()
+{
+    if (this->stream->state() != QAbstractSocket::UnconnectedState)
+        return;
+
+    this->stream->connectToHost(this->host, this->port);
+}
+
+void RelayForwarder::slConnected()
+{
+    qInfo("Connected to %s:%d", qPrintable(this->host), this->port);
+    if (this->dropped > 0)
+        qWarning("%llu batches were dropped", this->dropped);
+    this->dropped = 0;
+
+    // Send what was held while offline, oldest first
+    this->stream->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    while (!this->queued.isEmpty())
+        this->stream->write(this->queued.takeFirst());
+    this->queuedBytes = 0;
+}
+
+void RelayForwarder::slDisconnected()
+{
+    qWarning("Disconnected from %s:%d", qPrintable(this->host), this->port);
+    if (!this->reconnectTimer->isActive())
+        this->reconnectTimer->start(RELAY_RECONNECT_INTERVAL);
+}
+
+void RelayForwarder::slError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+
+    // Failed connection attempts don't emit disconnected()
+    if (this->stream->state() == QAbstractSocket::UnconnectedState &&
+        !this->reconnectTimer->isActive())
+        this->reconnectTimer->start(RELAY_RECONNECT_INTERVAL);
+}
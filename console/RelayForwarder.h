@@ -0,0 +1,53 @@
+#ifndef RELAYFORWARDER_H
+#define RELAYFORWARDER_H
+
+#include <QObject>
+#include <QUdpSocket>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QList>
+
+#include "RelayBatch.h"
+
+/**
+* Headless relay. Receives the datagrams sent on this node and forwards them
+* in compressed batches over a single TCP connection to a central console,
+* reconnecting whenever the connection drops.
+*/
+class RelayForwarder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void slPendingDatagrams();
+    void slFlush();
+    void slConnect();
+    void slConnected();
+    void slDisconnected();
+    void slError(QAbstractSocket::SocketError error);
+
+public:
+    explicit RelayForwarder(QObject *parent = 0);
+
+    bool start(const QHostAddress &listenIp, quint16 listenPort,
+               const QString &host, quint16 port, const QString &node);
+
+private:
+    QUdpSocket *listener;
+    QTcpSocket *stream;
+    QTimer *flushTimer;
+    QTimer *reconnectTimer;
+    QString host;
+    quint16 port;
+    int headerSize;
+    QByteArray batch;
+    QByteArray datagramBuffer;
+    QList<QByteArray> queued;
+    qint64 queuedBytes;
+    quint64 dropped;
+
+    void send(const QByteArray &frame);
+    void drop(int datagrams);
+};
+
+#endif // RELAYFORWARDER_H
@@ -0,0 +1,100 @@
+#include "RelayServer.h"
+
+#include <QtEndian>
+
+RelayServer::RelayServer(QObject *parent) :
+    QObject(parent),
+    retired(false)
+{
+    this->server = new QTcpServer(this);
+    connect(this->server,   SIGNAL(newConnection()),
+            this,           SLOT(slNewConnection()));
+}
+
+bool RelayServer::listen(const QHostAddress &ip, quint16 port)
+{
+    return this->server->listen(ip, port);
+}
+
+void RelayServer::retire()
+{
+    this->retired = true;
+    this->server->close();
+
+    if (this->buffers.isEmpty())
+        this->deleteLater();
+}
+
+void RelayServer::slNewConnection()
+{
+    while (this->server->hasPendingConnections())
+    {
+        QTcpSocket *socket = this->server->nextPendingConnection();
+        this->buffers.insert(socket, QByteArray());
+
+        connect(socket, SIGNAL(readyRead()),
+                this,   SLOT(slReadyRead()));
+        connect(socket, SIGNAL(disconnected()),
+                this,   SLOT(slDisconnected()));
+    }
+}
+
+void RelayServer::slReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(this->sender());
+    if (socket == NULL || !this->buffers.contains(socket))
+        return;
+
+    QByteArray &buffer = this->buffers[socket];
+    buffer += socket->readAll();
+
+    // Handle every complete frame, keeping the rest for the next read
+    int offset = 0;
+    while (buffer.size() - offset >= 4)
+    {
+        const uchar *data = (const uchar *) buffer.constData() + offset;
+        quint32 size = qFromBigEndian<quint32>(data);
+        if (size > RELAY_MAX_FRAME)
+        {
+            // Not a relay, or out of sync. Either way nothing more can be
+            // read from it.
+            this->buffers.remove(socket);
+            socket->abort();
+            socket->deleteLater();
+
+            if (this->retired && this->buffers.isEmpty())
+                this->deleteLater();
+            return;
+        }
+
+        if ((quint32) (buffer.size() - offset - 4) < size)
+            break;
+
+        // qUncompress() allocates whatever size the frame claims, so frames
+        // claiming more than a relay ever sends are dropped unread
+        QByteArray batch;
+        if (size >= 4 && qFromBigEndian<quint32>(data + 4) <=
+                                                        RELAY_MAX_INFLATED)
+            batch = qUncompress(data + 4, (int) size);
+        offset += 4 + (int) size;
+
+        if (!batch.isEmpty())
+            emit batchReceived(batch);
+    }
+
+    if (offset > 0)
+        buffer.remove(0, offset);
+}
+
+void RelayServer::slDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(this->sender());
+    if (socket == NULL)
+        return;
+
+    this->buffers.remove(socket);
+    socket->deleteLater();
+
+    if (this->retired && this->buffers.isEmpty())
+        this->deleteLater();
+}
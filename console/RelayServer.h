@@ -0,0 +1,46 @@
+#ifndef RELAYSERVER_H
+#define RELAYSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+
+#include "RelayBatch.h"
+
+/**
+* Accepts relay connections and emits every batch received, already
+* uncompressed. Each relay keeps a buffer until its frames are complete.
+*
+* A retired server accepts no more connections but keeps reading the open
+* ones, and deletes itself once they are all closed.
+*/
+class RelayServer : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void batchReceived(const QByteArray &batch);
+
+private slots:
+    void slNewConnection();
+    void slReadyRead();
+    void slDisconnected();
+
+public:
+    explicit RelayServer(QObject *parent = 0);
+
+    bool listen(const QHostAddress &ip, quint16 port);
+    void retire();
+    quint16 port() const { return this->server->serverPort(); }
+    QHostAddress address() const { return this->server->serverAddress(); }
+    QString errorString() const { return this->server->errorString(); }
+    int relayCount() const { return this->buffers.count(); }
+
+private:
+    QTcpServer *server;
+    QHash<QTcpSocket *, QByteArray> buffers;
+    bool retired;
+};
+
+#endif // RELAYSERVER_H
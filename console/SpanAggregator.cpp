@@ -0,0 +1,231 @@
+#include "SpanAggregator.h"
+
+#include <string.h>
+
+// Parent links followed at most when looking for the request of a span
+#define MAX_SPAN_DEPTH 32
+
+SpanHistogram::SpanHistogram()
+{
+    this->clear();
+}
+
+void SpanHistogram::clear()
+{
+    memset(this->counts, 0, sizeof(this->counts));
+    this->total = 0;
+}
+
+int SpanHistogram::indexOf(quint64 value)
+{
+    // Values below SPAN_SUB_BUCKETS are counted exactly. Above that, each
+    // power of two is split in SPAN_SUB_BUCKETS equal parts.
+    if (value < SPAN_SUB_BUCKETS)
+        return (int) value;
+
+    int msb = 63;
+    while (!(value & (Q_UINT64_C(1) << msb)))
+        --msb;
+
+    int sub = (int) (value >> (msb - 4)) & (SPAN_SUB_BUCKETS - 1);
+    return (msb - 3) * SPAN_SUB_BUCKETS + sub;
+}
+
+quint64 SpanHistogram::lowerBound(int index)
+{
+    if (index < SPAN_SUB_BUCKETS)
+        return index;
+
+    int msb = index / SPAN_SUB_BUCKETS + 3;
+    quint64 sub = index % SPAN_SUB_BUCKETS;
+    return (SPAN_SUB_BUCKETS + sub) << (msb - 4);
+}
+
+void SpanHistogram::add(quint64 value)
+{
+    ++this->counts[indexOf(value)];
+    ++this->total;
+}
+
+quint64 SpanHistogram::percentile(double fraction) const
+{
+    if (this->total == 0)
+        return 0;
+
+    quint64 rank = (quint64) (fraction * this->total);
+    if (rank >= this->total)
+        rank = this->total - 1;
+
+    // Report the middle of the bucket holding the ranked value
+    quint64 seen = 0;
+    for (int x = 0; x < SPAN_BUCKETS; ++x)
+    {
+        seen += this->counts[x];
+        if (seen > rank)
+        {
+            quint64 low = lowerBound(x);
+            quint64 high = (x + 1 < SPAN_BUCKETS) ? lowerBound(x + 1) : low;
+            return low + (high - low) / 2;
+        }
+    }
+
+    return 0;
+}
+
+double SpanStats::percentile(double fraction) const
+{
+    return this->histogram.percentile(fraction) / 1000.0;
+}
+
+SpanAggregator::SpanAggregator() :
+    sequence(0)
+{
+}
+
+SpanAggregator::~SpanAggregator()
+{
+    this->clear();
+}
+
+void SpanAggregator::clear()
+{
+    qDeleteAll(this->stats);
+    this->stats.clear();
+    this->statsByName.clear();
+    this->recent.clear();
+    this->recentById.clear();
+    this->sequence = 0;
+}
+
+void SpanAggregator::add(const QString &name, const QString &id,
+                         const QString &parent, double start, double duration)
+{
+    SpanStats *stats = this->statsByName.value(name, NULL);
+    if (stats == NULL)
+    {
+        stats = new SpanStats();
+        stats->name = name;
+        stats->count = 0;
+        stats->total = 0;
+        stats->min = duration;
+        stats->max = duration;
+        this->stats.append(stats);
+        this->statsByName.insert(name, stats);
+    }
+
+    ++stats->count;
+    stats->total += duration;
+    if (duration < stats->min)
+        stats->min = duration;
+    if (duration > stats->max)
+        stats->max = duration;
+    // Durations over ~30 years are counted as such, anything longer would
+    // overflow the microsecond count
+    stats->histogram.add((quint64) (qMin(duration, 1e12) * 1000));
+
+    // Keep the span in the recent ring, overwriting the oldest one once full
+    int slot = (int) (this->sequence % SPAN_RECENT);
+    if (this->recent.size() < SPAN_RECENT)
+        this->recent.resize(slot + 1);
+    else
+    {
+        const SpanRecord &old = this->recent.at(slot);
+        if (!old.id.isEmpty() && this->recentById.value(old.id, -1) == slot)
+            this->recentById.remove(old.id);
+    }
+
+    SpanRecord &record = this->recent[slot];
+    record.sequence = this->sequence++;
+    record.name = name;
+    record.id = id;
+    record.parent = parent;
+    record.start = start;
+    record.duration = duration;
+
+    if (!id.isEmpty())
+        this->recentById.insert(id, slot);
+}
+
+const SpanRecord *SpanAggregator::record(quint64 sequence) const
+{
+    if (sequence >= this->sequence ||
+        this->sequence - sequence > (quint64) this->recent.size())
+        return NULL;
+
+    return &this->recent.at((int) (sequence % SPAN_RECENT));
+}
+
+QList<SpanRecord> SpanAggregator::recentRequests(int max) const
+{
+    // Newest first
+    QList<SpanRecord> requests;
+    quint64 oldest = this->sequence - this->recent.size();
+    for (quint64 x = this->sequence; x > oldest && requests.count() < max; --x)
+    {
+        const SpanRecord &span = this->recent.at((int) ((x - 1) % SPAN_RECENT));
+        if (span.parent.isEmpty())
+            requests.append(span);
+    }
+
+    return requests;
+}
+
+int SpanAggregator::depthBelow(const SpanRecord &span,
+                               const QString &root) const
+{
+    // Follow parent links up to the request, -1 if it isn't reached
+    const SpanRecord *current = &span;
+    for (int depth = 1; depth <= MAX_SPAN_DEPTH; ++depth)
+    {
+        if (current->parent == root)
+            return depth;
+
+        int slot = this->recentById.value(current->parent, -1);
+        if (slot < 0)
+            return -1;
+        current = &this->recent.at(slot);
+        if (current->parent.isEmpty())
+            return -1;
+    }
+
+    return -1;
+}
+
+QVector<FlameSpan> SpanAggregator::flame(quint64 request) const
+{
+    QVector<FlameSpan> spans;
+    const SpanRecord *root = this->record(request);
+    if (root == NULL)
+        return spans;
+
+    FlameSpan top;
+    top.name = root->name;
+    top.start = 0;
+    top.duration = root->duration;
+    top.depth = 0;
+    spans.append(top);
+
+    // Spans without an id can't have children
+    if (root->id.isEmpty())
+        return spans;
+
+    for (int x = 0; x < this->recent.size(); ++x)
+    {
+        const SpanRecord &span = this->recent.at(x);
+        if (span.parent.isEmpty())
+            continue;
+
+        int depth = this->depthBelow(span, root->id);
+        if (depth < 0)
+            continue;
+
+        FlameSpan item;
+        item.name = span.name;
+        item.start = span.start - root->start;
+        item.duration = span.duration;
+        item.depth = depth;
+        spans.append(item);
+    }
+
+    return spans;
+}
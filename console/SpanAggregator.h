@@ -0,0 +1,110 @@
+#ifndef SPANAGGREGATOR_H
+#define SPANAGGREGATOR_H
+
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QHash>
+
+// Histogram buckets per power of two, and total buckets needed to cover
+// every 64 bit value
+#define SPAN_SUB_BUCKETS 16
+#define SPAN_BUCKETS     (61 * SPAN_SUB_BUCKETS)
+
+// Spans kept for the flame view
+#define SPAN_RECENT 20000
+
+/**
+* Log-linear histogram of span durations in microseconds. Memory use is
+* fixed and the relative error of any percentile is below 1/16.
+*/
+class SpanHistogram
+{
+public:
+    SpanHistogram();
+
+    void add(quint64 value);
+    quint64 percentile(double fraction) const;
+    void clear();
+
+private:
+    quint32 counts[SPAN_BUCKETS];
+    quint64 total;
+
+    static int indexOf(quint64 value);
+    static quint64 lowerBound(int index);
+};
+
+/**
+* Aggregated figures of all the spans sharing a name. Times are in ms.
+*/
+struct SpanStats
+{
+    QString name;
+    quint64 count;
+    double total;
+    double min;
+    double max;
+    SpanHistogram histogram;
+
+    double percentile(double fraction) const;
+};
+
+/**
+* Span as received, kept in the recent spans ring
+*/
+struct SpanRecord
+{
+    quint64 sequence;   /**< Position in the reception order     */
+    QString name;
+    QString id;
+    QString parent;     /**< Empty for request (root) spans      */
+    double start;       /**< ms, sender clock                    */
+    double duration;    /**< ms                                  */
+};
+
+/**
+* Span laid out for drawing, relative to the request start
+*/
+struct FlameSpan
+{
+    QString name;
+    double start;
+    double duration;
+    int depth;
+};
+
+/**
+* Incremental span statistics. Each span updates the figures of its name in
+* constant time, and the last SPAN_RECENT spans are kept so the call tree
+* of a recent request can be rebuilt.
+*/
+class SpanAggregator
+{
+public:
+    SpanAggregator();
+    ~SpanAggregator();
+
+    void add(const QString &name, const QString &id, const QString &parent,
+             double start, double duration);
+    void clear();
+
+    quint64 received() const { return this->sequence; }
+    int statsCount() const { return this->stats.count(); }
+    const SpanStats &statsAt(int index) const { return *this->stats.at(index); }
+
+    QList<SpanRecord> recentRequests(int max) const;
+    QVector<FlameSpan> flame(quint64 request) const;
+
+private:
+    QList<SpanStats *> stats;
+    QHash<QString, SpanStats *> statsByName;
+    QVector<SpanRecord> recent;
+    QHash<QString, int> recentById;
+    quint64 sequence;
+
+    const SpanRecord *record(quint64 sequence) const;
+    int depthBelow(const SpanRecord &span, const QString &root) const;
+};
+
+#endif // SPANAGGREGATOR_H
@@ -0,0 +1,203 @@
+#include "TimelineWidget.h"
+
+#include <QPainter>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QDateTime>
+
+// Visible time spans, in seconds
+static const qint64 timelineSpans[] = { 60, 300, 600, 1800, 3600, 3 * 3600,
+                                        6 * 3600, 12 * 3600, 24 * 3600 };
+static const int timelineSpanCount = sizeof(timelineSpans) / sizeof(qint64);
+
+// Drawing order, bottom to top. Untagged messages first and h1 on top.
+static const int timelineLevelOrder[RATE_LEVELS] = { 0, 6, 5, 4, 3, 2, 1 };
+
+TimelineWidget::TimelineWidget(QWidget *parent) :
+    QWidget(parent),
+    history(NULL), tab(-1), spanIndex(2), refreshTimer(NULL),
+    viewBegin(0), viewSpan(0), viewResolution(1)
+{
+    this->setMinimumHeight(48);
+    this->setMaximumHeight(48);
+    this->setCursor(Qt::PointingHandCursor);
+
+    this->levelColors.fill(QColor(150, 150, 150), RATE_LEVELS);
+
+    this->refreshTimer = new QTimer(this);
+    connect(this->refreshTimer, SIGNAL(timeout()),
+            this,               SLOT(slRefresh()));
+    this->refreshTimer->start(1000);
+}
+
+void TimelineWidget::setHistory(const RateHistory *history)
+{
+    this->history = history;
+    this->update();
+}
+
+void TimelineWidget::setTab(int tab)
+{
+    this->tab = tab;
+    this->update();
+}
+
+void TimelineWidget::setLevelColor(int level, QColor color)
+{
+    if (level < 0 || level >= RATE_LEVELS || !color.isValid())
+        return;
+
+    this->levelColors[level] = color;
+    this->update();
+}
+
+void TimelineWidget::slRefresh()
+{
+    if (this->isVisible())
+        this->update();
+}
+
+quint32 TimelineWidget::bucketCount(const RateBucket *bucket, int level) const
+{
+    if (this->tab >= 0)
+        return bucket->count[this->tab][level];
+
+    quint32 count = 0;
+    for (int x = 0; x < RATE_TABS; ++x)
+        count += bucket->count[x][level];
+
+    return count;
+}
+
+void TimelineWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(this->rect(), this->palette().base());
+    painter.setPen(this->palette().mid().color());
+    painter.drawRect(this->rect().adjusted(0, 0, -1, -1));
+
+    if (this->history == NULL)
+        return;
+
+    int w = this->width();
+    int h = this->height() - 2;
+    qint64 span = timelineSpans[this->spanIndex];
+    const RateRing &ring = this->history->ringFor(span, w);
+    int resolution = ring.resolution();
+
+    // Align the view to the ring buckets so bars don't jitter as time goes by
+    qint64 end = QDateTime::currentMSecsSinceEpoch() / 1000;
+    end = end - end % resolution + resolution;
+    qint64 begin = end - span;
+
+    this->viewBegin = begin;
+    this->viewSpan = span;
+    this->viewResolution = resolution;
+
+    // Find the peak rate so the chart scales to the visible data
+    double peak = 0;
+    for (qint64 slot = begin; slot < end; slot += resolution)
+    {
+        const RateBucket *bucket = ring.bucket(slot);
+        if (bucket == NULL)
+            continue;
+
+        quint32 total = 0;
+        for (int level = 0; level < RATE_LEVELS; ++level)
+            total += this->bucketCount(bucket, level);
+        peak = qMax(peak, (double) total / resolution);
+    }
+
+    if (peak > 0)
+    {
+        for (qint64 slot = begin; slot < end; slot += resolution)
+        {
+            const RateBucket *bucket = ring.bucket(slot);
+            if (bucket == NULL)
+                continue;
+
+            double x0 = (double) (slot - begin) * w / span;
+            double x1 = (double) (slot + resolution - begin) * w / span;
+            double barWidth = qMax(1.0, x1 - x0);
+            double y = h + 1;
+
+            for (int x = 0; x < RATE_LEVELS; ++x)
+            {
+                int level = timelineLevelOrder[x];
+                quint32 count = this->bucketCount(bucket, level);
+                if (count == 0)
+                    continue;
+
+                double barHeight = (count / (double) resolution) / peak * h;
+                y -= barHeight;
+                painter.fillRect(QRectF(x0, y, barWidth, barHeight),
+                                 this->levelColors.at(level));
+            }
+        }
+    }
+
+    // Scale and span captions
+    QString spanText = (span < 3600) ?
+                       tr("%1 min").arg(span / 60) :
+                       tr("%1 h").arg(span / 3600);
+    painter.setPen(this->palette().text().color());
+    painter.drawText(this->rect().adjusted(4, 2, -4, -2),
+                     Qt::AlignTop | Qt::AlignLeft,
+                     tr("%1 msg/s").arg(peak, 0, 'f', (peak < 10) ? 1 : 0));
+    painter.drawText(this->rect().adjusted(4, 2, -4, -2),
+                     Qt::AlignTop | Qt::AlignRight, spanText);
+}
+
+void TimelineWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (this->history == NULL || this->viewSpan <= 0 ||
+        event->button() != Qt::LeftButton)
+        return;
+
+    qint64 second = this->viewBegin +
+                    (qint64) event->pos().x() * this->viewSpan / this->width();
+    qint64 from = second - second % this->viewResolution;
+    qint64 to = from + this->viewResolution;
+
+    int target = this->tab;
+    if (target < 0)
+    {
+        // When all tabs are plotted jump to the busiest one in that slot
+        const RateRing &ring = this->history->ringFor(this->viewSpan,
+                                                      this->width());
+        const RateBucket *bucket = ring.bucket(from);
+        if (bucket == NULL)
+            return;
+
+        quint32 best = 0;
+        for (int x = 0; x < RATE_TABS; ++x)
+        {
+            quint32 count = 0;
+            for (int level = 0; level < RATE_LEVELS; ++level)
+                count += bucket->count[x][level];
+
+            if (count > best)
+            {
+                best = count;
+                target = x;
+            }
+        }
+    }
+
+    if (target >= 0)
+        emit spikeClicked(target, from, to);
+}
+
+void TimelineWidget::wheelEvent(QWheelEvent *event)
+{
+    if (event->angleDelta().y() > 0 && this->spanIndex > 0)
+        --this->spanIndex;
+    else if (event->angleDelta().y() < 0 &&
+             this->spanIndex < timelineSpanCount - 1)
+        ++this->spanIndex;
+
+    this->update();
+    event->accept();
+}
@@ -0,0 +1,51 @@
+#ifndef TIMELINEWIDGET_H
+#define TIMELINEWIDGET_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QVector>
+#include <QColor>
+
+#include "RateHistory.h"
+
+/**
+* Strip chart of the messages per second received, stacked by level. Wheel
+* changes the visible time span and clicking a bar emits the time range it
+* covers.
+*/
+class TimelineWidget : public QWidget
+{
+    Q_OBJECT
+
+signals:
+    void spikeClicked(int tab, qint64 from, qint64 to);
+
+private slots:
+    void slRefresh();
+
+public:
+    explicit TimelineWidget(QWidget *parent = 0);
+
+    void setHistory(const RateHistory *history);
+    void setTab(int tab);
+    void setLevelColor(int level, QColor color);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void wheelEvent(QWheelEvent *event);
+
+private:
+    const RateHistory *history;
+    int tab;
+    int spanIndex;
+    QVector<QColor> levelColors;
+    QTimer *refreshTimer;
+    qint64 viewBegin;
+    qint64 viewSpan;
+    int viewResolution;
+
+    quint32 bucketCount(const RateBucket *bucket, int level) const;
+};
+
+#endif // TIMELINEWIDGET_H
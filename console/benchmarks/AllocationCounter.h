@@ -0,0 +1,15 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+/**
+* Process wide heap allocation counter. On glibc every malloc() is counted,
+* which includes Qt's own containers. Elsewhere only operator new is seen.
+*/
+namespace AllocationCounter
+{
+    quint64 count();
+}
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,726 @@
+#include "MaurinaBenchmarks.h"
+#include "AllocationCounter.h"
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+
+// Number of appends after which the logs are cleared, so documents stay at a
+// size similar to what the clear timeout leaves in a real session
+#define APPENDS_PER_CLEAR 256
+
+/*
+ * Fixtures. Datagrams are built the same way the PHP connector builds them,
+ * including json_encode() escaping of slashes and non ASCII characters.
+ */
+
+static QByteArray jsonString(const QString &value)
+{
+    QByteArray out("\"");
+    out.reserve(value.size() + value.size() / 8 + 2);
+
+    int length = value.size();
+    for (int x = 0; x < length; ++x)
+    {
+        ushort c = value.at(x).unicode();
+        switch (c)
+        {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '/':  out += "\\/";  break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (c < 0x20 || c > 0x7e)
+                {
+                    out += "\\u";
+                    out += QByteArray::number(c, 16).rightJustified(4, '0');
+                }
+                else out += (char) c;
+        }
+    }
+
+    out += '"';
+    return out;
+}
+
+static QByteArray phpDatagram(int tab, const QString &message,
+                              const QString &level = QString())
+{
+    QByteArray datagram("{\"tabs\":[\"&User\",\"&Errors\",\"&Request\","
+                        "\"&Session\",\"&Cookies\"]");
+
+    for (int x = 0; x < 5; ++x)
+    {
+        datagram += ",\"log" + QByteArray::number(x + 1) + "\":";
+        datagram += jsonString((x == tab) ? message : QString());
+    }
+
+    if (!level.isEmpty())
+        datagram += ",\"level\":" + jsonString(level);
+
+    datagram += "}";
+    return datagram;
+}
+
+static QString smallLine()
+{
+    return "<time>[10:15:42]</time> Message sent using the log() method.";
+}
+
+static QString errorMessage()
+{
+    // As Maurina::errorHandler() formats it, source line through
+    // htmlentities()
+    return "<span style='color:#ff9e9e'>[E_WARNING] Line 27 in "
+           "/var/www/app/controllers/UserController.php</span><br />"
+           "<span style='color:#fffa9e'><em>echo &quot;Average: &quot; . "
+           "$total / $count;</em></span><br />Division by zero<br />";
+}
+
+static QString requestDump()
+{
+    QStringList lines;
+    for (int x = 0; x < 20; ++x)
+    {
+        lines << QString(" <span style=\"font-family:Consolas,Menlo,"
+                         "monospace;\"><strong style=\"color:#3488b6\">"
+                         "param%1</strong> :&nbsp;value número %1</span>")
+                 .arg(x);
+    }
+
+    return lines.join("<br /><br />") + "<br />";
+}
+
+static QString hugePreDump()
+{
+    // Close to the largest message that fits in a datagram once escaped
+    QString dump("<br /><pre>Array\n(\n");
+    for (int x = 0; x < 1000; ++x)
+        dump += QString("    [session_key_%1] => stored value %1\n").arg(x);
+    dump += ")\n</pre>";
+
+    return dump;
+}
+
+static QStringList watchPatterns()
+{
+    // A few hundred patterns, as a watchlist of known errors would have
+    QStringList patterns;
+    patterns << "Allowed memory size" << "SQLSTATE[" << "Division by zero"
+             << "Maximum execution time" << "Call to undefined function";
+    for (int x = 0; patterns.count() < 300; ++x)
+    {
+        patterns << QString("PDOException %1").arg(x)
+                 << QString("App\\Exception\\Error%1Exception").arg(x)
+                 << QString("ORA-%1").arg(20000 + x, 5, 10, QLatin1Char('0'));
+    }
+
+    return patterns;
+}
+
+static int datagramLog(const QByteArray &datagram, QString *message)
+{
+    DatagramDecoder decoder;
+    decoder.decode(datagram);
+    for (int x = 0; x < DATAGRAM_LOGS; ++x)
+    {
+        *message = decoder.log(x).toString();
+        if (!message->isEmpty())
+            return x;
+    }
+
+    return 0;
+}
+
+template <typename Operation>
+static void reportStage(const char *stage, int bytes, Operation operation)
+{
+    const int iterations = 100;
+
+    // Warm up caches before measuring
+    operation();
+
+    quint64 allocations = AllocationCounter::count();
+    QElapsedTimer timer;
+    timer.start();
+    for (int x = 0; x < iterations; ++x)
+        operation();
+    qint64 elapsed = timer.nsecsElapsed();
+    allocations = AllocationCounter::count() - allocations;
+
+    double nsPerOp = (double) elapsed / iterations;
+    const char *tag = QTest::currentDataTag();
+    qDebug("%s [%s]: %.0f ns/op, %.1f allocs/op, %.1f MB/s", stage,
+           (tag != NULL) ? tag : "", nsPerOp,
+           (double) allocations / iterations,
+           (nsPerOp > 0) ? bytes * 1000.0 / nsPerOp : 0.0);
+}
+
+MaurinaBenchmarks::MaurinaBenchmarks(QObject *parent) :
+    QObject(parent),
+    window(NULL)
+{
+}
+
+void MaurinaBenchmarks::initTestCase()
+{
+    // Let the system pick the port so a running console doesn't make the
+    // bind fail. History is off so ingest figures don't include disk
+    // writes, appendHistory measures those on its own.
+    QString userFolder = QDir::homePath() + "/.maurina/";
+    QDir().mkpath(userFolder);
+
+    QFile config(userFolder + CONFIG_FILE);
+    QVERIFY(config.open(QIODevice::WriteOnly));
+    config.write("serverIp = 127.0.0.1\nserverPort = 0\n"
+                 "historyEnabled = 0\n");
+    config.close();
+
+    this->window = new MainWindow();
+    this->window->show();
+    this->defaultStyles = this->window->styles;
+}
+
+void MaurinaBenchmarks::cleanupTestCase()
+{
+    delete this->window;
+    this->window = NULL;
+}
+
+void MaurinaBenchmarks::init()
+{
+    this->window->styles = this->defaultStyles;
+    this->window->compileStyles();
+    if (this->window->layoutType != DetailedLayout)
+        this->window->slChangeLayout();
+    this->window->slClearLogs();
+}
+
+void MaurinaBenchmarks::addPayloadRows()
+{
+    QTest::addColumn<QByteArray>("datagram");
+    QTest::addColumn<int>("styleCount");
+
+    int styles = this->defaultStyles.count();
+    QTest::newRow("small line") << phpDatagram(0, smallLine()) << styles;
+    QTest::newRow("error") << phpDatagram(1, errorMessage(), "warning")
+                           << styles;
+    QTest::newRow("request dump") << phpDatagram(2, requestDump()) << styles;
+    QTest::newRow("huge pre dump") << phpDatagram(0, hugePreDump()) << styles;
+    QTest::newRow("small line, many styles") << phpDatagram(0, smallLine())
+                                             << 64;
+    QTest::newRow("huge pre dump, many styles")
+            << phpDatagram(0, hugePreDump()) << 64;
+}
+
+void MaurinaBenchmarks::applyStyleCount(int count)
+{
+    // Pad the default styles with user defined ones
+    QHash<QString, QString> styles = this->defaultStyles;
+    QString style = styles.value("var");
+    for (int x = 0; styles.count() < count; ++x)
+        styles["tag" + QString::number(x)] = style;
+
+    this->window->styles = styles;
+    this->window->compileStyles();
+}
+
+void MaurinaBenchmarks::parseDatagram_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::parseDatagram()
+{
+    QFETCH(QByteArray, datagram);
+
+    // Only the tokenizing step of processDatagram(), through the decoder
+    // instance the window itself uses
+    DatagramDecoder &decoder = this->window->decoder;
+    QVERIFY(decoder.decode(datagram));
+
+    auto parse = [&]()
+    {
+        decoder.decode(datagram);
+    };
+
+    QBENCHMARK
+    {
+        parse();
+    }
+
+    reportStage("parseDatagram", datagram.size(), parse);
+}
+
+void MaurinaBenchmarks::decodeDatagram_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::decodeDatagram()
+{
+    QFETCH(QByteArray, datagram);
+
+    // The decoder must agree with a generic JSON parser before measuring it
+    QVariantMap reference =
+                        QJsonDocument::fromJson(datagram).toVariant().toMap();
+    DatagramDecoder &decoder = this->window->decoder;
+    QVERIFY(decoder.decode(datagram));
+
+    QStringList referenceTabs = reference["tabs"].toStringList();
+    QCOMPARE(decoder.tabCount(), referenceTabs.count());
+    for (int x = 0; x < decoder.tabCount(); ++x)
+        QCOMPARE(decoder.tab(x).toString(), referenceTabs.at(x));
+    for (int x = 0; x < DATAGRAM_LOGS; ++x)
+    {
+        QCOMPARE(decoder.log(x).toString(),
+                 reference["log" + QString::number(x + 1)].toString());
+    }
+
+    // Same work processDatagram() does: captions plus non empty logs
+    QStringList tabs;
+    QString logs[DATAGRAM_LOGS];
+    auto decode = [&]()
+    {
+        if (!decoder.decode(datagram))
+            return;
+
+        tabs.clear();
+        for (int x = 0; x < decoder.tabCount(); ++x)
+            tabs << decoder.tab(x).toString();
+        for (int x = 0; x < DATAGRAM_LOGS; ++x)
+        {
+            if (!decoder.log(x).isEmpty())
+                logs[x] = decoder.log(x).toString();
+        }
+    };
+
+    QBENCHMARK
+    {
+        decode();
+    }
+
+    reportStage("decodeDatagram", datagram.size(), decode);
+}
+
+void MaurinaBenchmarks::parseDatagramJson_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::parseDatagramJson()
+{
+    QFETCH(QByteArray, datagram);
+
+    // Decoding processDatagram() did before DatagramDecoder, kept as the
+    // reference decodeDatagram is compared against
+    QStringList tabs;
+    QString logs[5];
+    auto parse = [&]()
+    {
+        QVariantMap data =
+                        QJsonDocument::fromJson(datagram).toVariant().toMap();
+        tabs = data["tabs"].toStringList();
+        logs[0] = data["log1"].toString();
+        logs[1] = data["log2"].toString();
+        logs[2] = data["log3"].toString();
+        logs[3] = data["log4"].toString();
+        logs[4] = data["log5"].toString();
+    };
+
+    QBENCHMARK
+    {
+        parse();
+    }
+
+    reportStage("parseDatagramJson", datagram.size(), parse);
+}
+
+void MaurinaBenchmarks::formatData_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::formatData()
+{
+    QFETCH(QByteArray, datagram);
+    QFETCH(int, styleCount);
+
+    this->applyStyleCount(styleCount);
+
+    QString message;
+    datagramLog(datagram, &message);
+
+    QString result;
+    auto format = [&]()
+    {
+        result = this->window->formatData(message);
+    };
+
+    QBENCHMARK
+    {
+        format();
+    }
+
+    reportStage("formatData", (int) (message.size() * sizeof(QChar)),
+                format);
+}
+
+void MaurinaBenchmarks::addDataToLog_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::addDataToLog()
+{
+    QFETCH(QByteArray, datagram);
+    QFETCH(int, styleCount);
+
+    this->applyStyleCount(styleCount);
+
+    QString message;
+    int tab = datagramLog(datagram, &message);
+
+    int appended = 0;
+    auto append = [&]()
+    {
+        if (++appended % APPENDS_PER_CLEAR == 0)
+            this->window->slClearLogs();
+        this->window->addDataToLog(tab, message);
+    };
+
+    QBENCHMARK
+    {
+        append();
+    }
+
+    reportStage("addDataToLog", (int) (message.size() * sizeof(QChar)),
+                append);
+}
+
+void MaurinaBenchmarks::setTabCaptions_data()
+{
+    QTest::addColumn<int>("layout");
+
+    QTest::newRow("detailed layout") << (int) DetailedLayout;
+    QTest::newRow("compact layout") << (int) CompactLayout;
+}
+
+void MaurinaBenchmarks::setTabCaptions()
+{
+    QFETCH(int, layout);
+
+    if (this->window->layoutType != (LayoutType) layout)
+        this->window->slChangeLayout();
+
+    this->window->tabCaptions = QStringList() << "&User" << "&Errors"
+                                << "&Request" << "&Session" << "&Cookies";
+    for (int x = 0; x < 5; ++x)
+        this->window->logCount[x] = 100 + x;
+
+    auto update = [&]()
+    {
+        this->window->setTabCaptions();
+    };
+
+    QBENCHMARK
+    {
+        update();
+    }
+
+    reportStage("setTabCaptions", 0, update);
+}
+
+void MaurinaBenchmarks::processDatagram_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::processDatagram()
+{
+    QFETCH(QByteArray, datagram);
+    QFETCH(int, styleCount);
+
+    this->applyStyleCount(styleCount);
+
+    // Render each datagram before the next one arrives, as an idle console
+    // does
+    int processed = 0;
+    auto process = [&]()
+    {
+        if (++processed % APPENDS_PER_CLEAR == 0)
+            this->window->slClearLogs();
+        this->window->processDatagram(datagram);
+        this->window->slFlushLanes();
+    };
+
+    QBENCHMARK
+    {
+        process();
+    }
+
+    reportStage("processDatagram", datagram.size(), process);
+}
+
+void MaurinaBenchmarks::processBatch_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::processBatch()
+{
+    QFETCH(QByteArray, datagram);
+    QFETCH(int, styleCount);
+
+    this->applyStyleCount(styleCount);
+
+    // A burst of datagrams rendered in a single lane flush, as a busy
+    // console does. Reported figures are per batch.
+    const int batchSize = 64;
+    int processed = 0;
+    auto process = [&]()
+    {
+        for (int x = 0; x < batchSize; ++x)
+            this->window->processDatagram(datagram);
+        this->window->slFlushLanes();
+
+        processed += batchSize;
+        if (processed >= APPENDS_PER_CLEAR)
+        {
+            processed = 0;
+            this->window->slClearLogs();
+        }
+    };
+
+    QBENCHMARK
+    {
+        process();
+    }
+
+    reportStage("processBatch", datagram.size() * batchSize, process);
+}
+
+void MaurinaBenchmarks::appendHistory_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::appendHistory()
+{
+    QFETCH(QByteArray, datagram);
+
+    QString message;
+    int tab = datagramLog(datagram, &message);
+    QByteArray stored = message.toUtf8();
+
+    // Segment files are dropped now and then so the run doesn't fill the
+    // disk
+    QTemporaryDir folder;
+    HistoryStore store;
+    QVERIFY(store.open(folder.path()));
+
+    int appended = 0;
+    auto append = [&]()
+    {
+        if (++appended % APPENDS_PER_CLEAR == 0)
+        {
+            store.close();
+            QDir(folder.path()).removeRecursively();
+            store.open(folder.path());
+        }
+        store.append(QDateTime::currentMSecsSinceEpoch(), tab, 0, stored);
+    };
+
+    QBENCHMARK
+    {
+        append();
+    }
+
+    reportStage("appendHistory", stored.size(), append);
+}
+
+void MaurinaBenchmarks::scanWatchlist_data()
+{
+    this->addPayloadRows();
+}
+
+void MaurinaBenchmarks::scanWatchlist()
+{
+    QFETCH(QByteArray, datagram);
+
+    QString message;
+    datagramLog(datagram, &message);
+
+    KeywordMatcher matcher;
+    matcher.compile(watchPatterns());
+    QVector<KeywordMatch> matches;
+
+    auto scan = [&]()
+    {
+        matcher.scan(message, &matches);
+    };
+
+    QBENCHMARK
+    {
+        scan();
+    }
+
+    reportStage("scanWatchlist", (int) (message.size() * sizeof(QChar)),
+                scan);
+}
+
+/*
+ * Checks
+ */
+
+void MaurinaBenchmarks::watchlistMatch_data()
+{
+    QTest::addColumn<QStringList>("patterns");
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("matchCount");
+    QTest::addColumn<QString>("highlighted");
+
+    QStringList reilly("O'Reilly");
+    QStringList cafe(QString::fromUtf8("caf\xc3\xa9 au lait"));
+    QStringList overlapping;
+    overlapping << "he" << "she" << "his" << "hers";
+
+    // References as htmlentities() writes them
+    QTest::newRow("&#039;")
+            << reilly << "by O&#039;Reilly" << 1
+            << "by <watch>O&#039;Reilly</watch>";
+    QTest::newRow("&#x27;")
+            << reilly << "O&#x27;REILLY" << 1
+            << "<watch>O&#x27;REILLY</watch>";
+    QTest::newRow("&eacute; and &nbsp;")
+            << cafe << "Caf&eacute;&nbsp;au lait" << 1
+            << "<watch>Caf&eacute;&nbsp;au lait</watch>";
+    QTest::newRow("raw character")
+            << cafe << QString::fromUtf8("CAF\xc3\x89 au lait") << 1
+            << QString::fromUtf8("<watch>CAF\xc3\x89 au lait</watch>");
+    QTest::newRow("&amp;")
+            << QStringList("a & b") << "a &amp; b, a & b" << 2
+            << "<watch>a &amp; b</watch>, <watch>a & b</watch>";
+    QTest::newRow("&lt; and tags")
+            << QStringList("x<y") << "x&lt;y <b>x</b>&lt;y" << 1
+            << "<watch>x&lt;y</watch> <b>x</b>&lt;y";
+
+    // Highlighting never splits a reference
+    QTest::newRow("reference name")
+            << QStringList("eacute") << "caf&eacute;" << 0
+            << "caf&eacute;";
+    QTest::newRow("ends in a reference")
+            << QStringList(QString::fromUtf8("caf\xc3\xa9"))
+            << "caf&eacute;s" << 1 << "<watch>caf&eacute;</watch>s";
+    QTest::newRow("starts in a reference")
+            << QStringList(QString::fromUtf8("\xc3\xa9s")) << "caf&eacute;s"
+            << 1 << "caf<watch>&eacute;s</watch>";
+
+    // Overlapping patterns: leftmost, then longest, is highlighted
+    QTest::newRow("overlapping")
+            << overlapping << "ushers" << 3 << "u<watch>she</watch>rs";
+    QTest::newRow("nested")
+            << overlapping << "HIS hers" << 3
+            << "<watch>HIS</watch> <watch>hers</watch>";
+}
+
+void MaurinaBenchmarks::watchlistMatch()
+{
+    QFETCH(QStringList, patterns);
+    QFETCH(QString, text);
+    QFETCH(int, matchCount);
+    QFETCH(QString, highlighted);
+
+    KeywordMatcher matcher;
+    matcher.compile(patterns);
+
+    QVector<KeywordMatch> matches;
+    QCOMPARE(matcher.scan(text, &matches), matchCount > 0);
+    QCOMPARE(matches.count(), matchCount);
+    QCOMPARE(KeywordMatcher::highlight(text, matches, "watch"), highlighted);
+}
+
+// Searches rows [from, to) a chunk at a time, as historyWindow does
+static qint64 findInChunks(HistoryStore *store, const QString &text,
+                           qint64 from, qint64 to, qint64 chunkBytes)
+{
+    qint64 row = from;
+    for (qint64 calls = 0; row < to && calls <= store->count(); ++calls)
+    {
+        qint64 found = store->find(text, &row, to, chunkBytes);
+        if (found >= 0)
+            return found;
+    }
+
+    return -1;
+}
+
+void MaurinaBenchmarks::historyFind_data()
+{
+    QTest::addColumn<qint64>("chunkBytes");
+
+    QTest::newRow("1 byte chunks") << Q_INT64_C(1);
+    QTest::newRow("50 byte chunks") << Q_INT64_C(50);
+    QTest::newRow("single chunk") << (Q_INT64_C(1) << 20);
+}
+
+void MaurinaBenchmarks::historyFind()
+{
+    QFETCH(qint64, chunkBytes);
+
+    // 30 messages in segments of 8: rows 0-7, 8-15, 16-23 and 24-29
+    QTemporaryDir folder;
+    HistoryStore store;
+    store.setSegmentSize(8, HISTORY_SEGMENT_BYTES);
+    QVERIFY(store.open(folder.path()));
+
+    for (int x = 0; x < 30; ++x)
+    {
+        QByteArray message = "message " + QByteArray::number(x);
+        if (x == 5)
+            message += " with a needle";
+        if (x == 10)
+            message += " ends with nee";
+        if (x == 11)
+            message = "dle starts this one";
+        if (x == 20)
+            message += " with a NEEDLE";
+        store.append(x, 0, 0, message);
+    }
+    QCOMPARE(store.count(), Q_INT64_C(30));
+
+    // Case is ignored, and text split between messages 10 and 11 is not a
+    // match. Message 20 is two segments past the start.
+    QCOMPARE(findInChunks(&store, "needle", 0, 30, chunkBytes), Q_INT64_C(5));
+    QCOMPARE(findInChunks(&store, "needle", 6, 30, chunkBytes),
+             Q_INT64_C(20));
+    QCOMPARE(findInChunks(&store, "message 29", 0, 30, chunkBytes),
+             Q_INT64_C(29));
+    QCOMPARE(findInChunks(&store, "needles", 0, 30, chunkBytes),
+             Q_INT64_C(-1));
+
+    // Nothing after the selected row, so the search wraps around and only
+    // looks at the rows before it
+    QCOMPARE(findInChunks(&store, "needle", 21, 30, chunkBytes),
+             Q_INT64_C(-1));
+    QCOMPARE(findInChunks(&store, "needle", 0, 21, chunkBytes), Q_INT64_C(5));
+    QCOMPARE(findInChunks(&store, "needle", 6, 20, chunkBytes),
+             Q_INT64_C(-1));
+
+    // Every call moves forward, and a search that finds nothing leaves its
+    // position at the end
+    qint64 row = 0;
+    for (int calls = 0; row < 30 && calls < 30; ++calls)
+    {
+        qint64 before = row;
+        QCOMPARE(store.find("needles", &row, 30, chunkBytes), Q_INT64_C(-1));
+        QVERIFY(row > before);
+    }
+    QCOMPARE(row, Q_INT64_C(30));
+
+    // Found messages read back whole
+    QCOMPARE(store.message(20), QString("message 20 with a NEEDLE"));
+}
@@ -0,0 +1,62 @@
+#ifndef MAURINABENCHMARKS_H
+#define MAURINABENCHMARKS_H
+
+#include <QObject>
+#include <QHash>
+
+#include "MainWindow.h"
+
+/**
+* QBENCHMARK cases for the console hot paths. Each case also prints the cost
+* per operation (time, heap allocations and throughput) of the stage.
+*
+* Checks of the code those paths rely on, but that a benchmark can't catch
+* breaking, run along with them.
+*/
+class MaurinaBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void parseDatagram_data();
+    void parseDatagram();
+    void decodeDatagram_data();
+    void decodeDatagram();
+    void parseDatagramJson_data();
+    void parseDatagramJson();
+    void formatData_data();
+    void formatData();
+    void addDataToLog_data();
+    void addDataToLog();
+    void setTabCaptions_data();
+    void setTabCaptions();
+    void processDatagram_data();
+    void processDatagram();
+    void processBatch_data();
+    void processBatch();
+    void appendHistory_data();
+    void appendHistory();
+    void scanWatchlist_data();
+    void scanWatchlist();
+
+    void watchlistMatch_data();
+    void watchlistMatch();
+    void historyFind_data();
+    void historyFind();
+
+public:
+    explicit MaurinaBenchmarks(QObject *parent = 0);
+
+private:
+    MainWindow *window;
+    QHash<QString, QString> defaultStyles;
+
+    void addPayloadRows();
+    void applyStyleCount(int count);
+};
+
+#endif // MAURINABENCHMARKS_H
@@ -0,0 +1,27 @@
+#-------------------------------------------------
+#
+# Micro-benchmarks for the ingest and render hot paths.
+#
+# Run with "make check" or run the binary directly. Results can be saved
+# for comparison between builds with e.g. "./benchmarks -o result.xml,xml".
+#
+#-------------------------------------------------
+
+QT       += core gui network testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = benchmarks
+TEMPLATE = app
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+
+SOURCES += main.cpp \
+    MaurinaBenchmarks.cpp \
+    AllocationCounter.cpp
+
+HEADERS  += MaurinaBenchmarks.h \
+    AllocationCounter.h
+
+include(../maurina.pri)
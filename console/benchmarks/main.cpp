@@ -0,0 +1,23 @@
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "MaurinaBenchmarks.h"
+
+int main(int argc, char *argv[])
+{
+    // Run headless unless told otherwise
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // The console reads and writes its config in the home folder. Use a
+    // throwaway one so benchmarks never touch the user's settings.
+    QTemporaryDir home;
+    qputenv("HOME", home.path().toLocal8Bit());
+    qputenv("USERPROFILE", home.path().toLocal8Bit());
+
+    QApplication app(argc, argv);
+    MaurinaBenchmarks benchmarks;
+
+    return QTest::qExec(&benchmarks, argc, argv);
+}
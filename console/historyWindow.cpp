@@ -0,0 +1,130 @@
+#include "historyWindow.h"
+#include "ui_historyWindow.h"
+
+#include <QHeaderView>
+
+historyWindow::historyWindow(HistoryStore *store, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::historyWindow),
+    store(store),
+    searchStart(0), searchNext(0), searchWrapped(false)
+{
+    ui->setupUi(this);
+
+    this->model = new HistoryModel(store, this);
+    ui->uiMessages->setModel(this->model);
+
+    // Fixed row heights keep the view fast with millions of rows
+    ui->uiMessages->verticalHeader()->hide();
+    ui->uiMessages->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->uiMessages->verticalHeader()->setDefaultSectionSize(
+                                            this->fontMetrics().height() + 4);
+    ui->uiMessages->horizontalHeader()->setStretchLastSection(true);
+    ui->uiMessages->setColumnWidth(0, 140);
+    ui->uiMessages->setColumnWidth(1, 90);
+
+    // Pick up new messages while the window is open
+    this->refreshTimer = new QTimer(this);
+    this->refreshTimer->start(1000);
+
+    // Searches run a chunk per event loop pass
+    this->searchTimer = new QTimer(this);
+    this->searchTimer->setSingleShot(true);
+    this->searchTimer->setInterval(0);
+
+    connect(ui->uiCloseButton,  SIGNAL(clicked()),
+            this,               SLOT(close()));
+    connect(ui->uiFindButton,   SIGNAL(clicked()),
+            this,               SLOT(slFind()));
+    connect(ui->uiSearch,       SIGNAL(returnPressed()),
+            this,               SLOT(slFind()));
+    connect(this->refreshTimer, SIGNAL(timeout()),
+            this,               SLOT(slRefresh()));
+    connect(this->searchTimer,  SIGNAL(timeout()),
+            this,               SLOT(slSearchStep()));
+
+    ui->uiCount->setText(tr("%1 messages").arg(this->model->rowCount()));
+    ui->uiMessages->scrollToBottom();
+}
+
+historyWindow::~historyWindow()
+{
+    delete ui;
+}
+
+void historyWindow::setTabCaptions(const QStringList &captions)
+{
+    this->model->setTabCaptions(captions);
+}
+
+void historyWindow::slRefresh()
+{
+    if (!this->isVisible())
+        return;
+
+    this->model->refresh();
+    ui->uiCount->setText(tr("%1 messages").arg(this->model->rowCount()));
+}
+
+void historyWindow::slFind()
+{
+    QString text = ui->uiSearch->text();
+    if (text.isEmpty())
+        return;
+
+    // Search forward from the selected message, wrapping around
+    this->model->refresh();
+    QModelIndex current = ui->uiMessages->currentIndex();
+    qint64 from = current.isValid() ? current.row() + 1 : 0;
+
+    this->searchText = text;
+    this->searchStart = this->store->base() + from;
+    this->searchNext = this->searchStart;
+    this->searchWrapped = false;
+
+    ui->uiCount->setText(tr("Searching..."));
+    this->searchTimer->start();
+}
+
+void historyWindow::slSearchStep()
+{
+    qint64 base = this->store->base();
+    qint64 row = this->searchNext - base;
+    qint64 to = this->searchWrapped ? this->searchStart - base :
+                                      this->store->count();
+
+    qint64 found = this->store->find(this->searchText, &row, to,
+                                     SEARCH_CHUNK_BYTES);
+    this->searchNext = base + row;
+
+    if (found >= 0)
+    {
+        this->model->refresh();
+        QModelIndex index = this->model->index((int) found, 2);
+        ui->uiMessages->setCurrentIndex(index);
+        ui->uiMessages->scrollTo(index, QAbstractItemView::PositionAtCenter);
+        this->stopSearch(tr("%1 messages").arg(this->model->rowCount()));
+        return;
+    }
+
+    if (row >= to)
+    {
+        // Once at the end, go on from the oldest message kept
+        if (this->searchWrapped || this->searchStart <= base)
+        {
+            this->stopSearch(tr("Not found"));
+            return;
+        }
+
+        this->searchWrapped = true;
+        this->searchNext = base;
+    }
+
+    this->searchTimer->start();
+}
+
+void historyWindow::stopSearch(const QString &status)
+{
+    this->searchTimer->stop();
+    ui->uiCount->setText(status);
+}
@@ -0,0 +1,50 @@
+#ifndef HISTORYWINDOW_H
+#define HISTORYWINDOW_H
+
+#include <QDialog>
+#include <QTimer>
+
+// Bytes of messages searched before letting the event loop run
+#define SEARCH_CHUNK_BYTES (Q_INT64_C(4) << 20)
+
+#include "HistoryStore.h"
+#include "HistoryModel.h"
+
+namespace Ui {
+class historyWindow;
+}
+
+class historyWindow : public QDialog
+{
+    Q_OBJECT
+
+private slots:
+    void slFind();
+    void slSearchStep();
+    void slRefresh();
+
+public:
+    explicit historyWindow(HistoryStore *store, QWidget *parent = 0);
+    ~historyWindow();
+
+    void setTabCaptions(const QStringList &captions);
+
+private:
+    Ui::historyWindow *ui;
+
+    HistoryStore *store;
+    HistoryModel *model;
+    QTimer *refreshTimer;
+
+    // Search in progress. Positions are message numbers since the history
+    // was created, so they survive old segments being dropped.
+    QTimer *searchTimer;
+    QString searchText;
+    qint64 searchStart;
+    qint64 searchNext;
+    bool searchWrapped;
+
+    void stopSearch(const QString &status);
+};
+
+#endif // HISTORYWINDOW_H
@@ -1,6 +1,44 @@
 <?xml version="1.0" encoding="utf-8"?>
 <!DOCTYPE TS>
-<TS version="2.0" language="es_ES">
+<TS version="2.1" language="es_ES">
+<context>
+    <name>FlameWidget</name>
+    <message>
+        <location filename="../FlameWidget.cpp" line="54"/>
+        <source>%1
+%2 ms, starts at %3 ms</source>
+        <translation>%1
+%2 ms, empieza en %3 ms</translation>
+    </message>
+    <message>
+        <location filename="../FlameWidget.cpp" line="78"/>
+        <source>Select a request to see its spans</source>
+        <translation>Selecciona una petición para ver sus spans</translation>
+    </message>
+</context>
+<context>
+    <name>HistoryModel</name>
+    <message>
+        <location filename="../HistoryModel.cpp" line="89"/>
+        <source>Log %1</source>
+        <translation>Log %1</translation>
+    </message>
+    <message>
+        <location filename="../HistoryModel.cpp" line="107"/>
+        <source>Time</source>
+        <translation>Hora</translation>
+    </message>
+    <message>
+        <location filename="../HistoryModel.cpp" line="108"/>
+        <source>Log</source>
+        <translation>Log</translation>
+    </message>
+    <message>
+        <location filename="../HistoryModel.cpp" line="111"/>
+        <source>Message</source>
+        <translation>Mensaje</translation>
+    </message>
+</context>
 <context>
     <name>MainWindow</name>
     <message>
@@ -10,23 +48,23 @@
     </message>
     <message>
         <source>Server</source>
-        <translation>Servidor</translation>
+        <translation type="vanished">Servidor</translation>
     </message>
     <message>
         <source>Port</source>
-        <translation>Puerto</translation>
+        <translation type="vanished">Puerto</translation>
     </message>
     <message>
         <source>Restart</source>
-        <translation>Reiniciar</translation>
+        <translation type="vanished">Reiniciar</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="490"/>
+        <location filename="../MainWindow.ui" line="510"/>
         <source>Clear timeout</source>
         <translation>Espera de borrado</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="511"/>
+        <location filename="../MainWindow.ui" line="531"/>
         <source>Clear now</source>
         <translation>Borrar ahora</translation>
     </message>
@@ -81,78 +119,184 @@
         <translation>Campo E</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="470"/>
+        <location filename="../MainWindow.ui" line="473"/>
         <source>TextLabel</source>
         <translation>TextLabel</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="504"/>
+        <location filename="../MainWindow.ui" line="524"/>
         <source>seconds</source>
         <translation>segundos</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="533"/>
+        <location filename="../MainWindow.ui" line="553"/>
         <source>File</source>
         <translation>Archivo</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="550"/>
+        <location filename="../MainWindow.ui" line="573"/>
         <source>&amp;About</source>
         <translation>&amp;Acerca de</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="555"/>
+        <location filename="../MainWindow.ui" line="578"/>
         <source>E&amp;xit</source>
         <translation>&amp;Salir</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="560"/>
+        <location filename="../MainWindow.ui" line="583"/>
         <source>&amp;Hide controls</source>
         <translation>Esconder &amp;controles</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="565"/>
+        <location filename="../MainWindow.ui" line="588"/>
         <source>Change &amp;layout</source>
         <translation>Cambiar &amp;distribución</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="570"/>
+        <location filename="../MainWindow.ui" line="596"/>
+        <source>Show &amp;timeline</source>
+        <translation>Mostrar &amp;línea de tiempo</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.ui" line="601"/>
+        <source>Hi&amp;story</source>
+        <translation>&amp;Historial</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.ui" line="606"/>
+        <source>P&amp;rofiler</source>
+        <translation>&amp;Perfilador</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.ui" line="611"/>
         <source>&amp;Preferences</source>
         <translation>&amp;Preferencias</translation>
     </message>
     <message>
-        <location filename="../MainWindow.ui" line="575"/>
+        <location filename="../MainWindow.ui" line="616"/>
         <source>Change screen &amp;mode</source>
         <translation>Cambiar &amp;modo de pantalla</translation>
     </message>
     <message>
-        <location filename="../MainWindow.cpp" line="65"/>
-        <location filename="../MainWindow.cpp" line="443"/>
+        <location filename="../MainWindow.cpp" line="93"/>
+        <location filename="../MainWindow.cpp" line="1144"/>
         <source>Ctrl+P</source>
         <translation>Ctrl+P</translation>
     </message>
     <message>
-        <location filename="../MainWindow.cpp" line="66"/>
-        <location filename="../MainWindow.cpp" line="423"/>
+        <location filename="../MainWindow.cpp" line="94"/>
+        <location filename="../MainWindow.cpp" line="1124"/>
         <source>Ctrl+H</source>
         <translation>Ctrl+H</translation>
     </message>
     <message>
-        <location filename="../MainWindow.cpp" line="67"/>
-        <location filename="../MainWindow.cpp" line="438"/>
+        <location filename="../MainWindow.cpp" line="95"/>
+        <location filename="../MainWindow.cpp" line="1139"/>
         <source>Ctrl+L</source>
         <translation>Ctrl+L</translation>
     </message>
     <message>
-        <location filename="../MainWindow.cpp" line="130"/>
+        <location filename="../MainWindow.cpp" line="96"/>
+        <location filename="../MainWindow.cpp" line="1149"/>
+        <source>Ctrl+T</source>
+        <translation>Ctrl+T</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="98"/>
+        <location filename="../MainWindow.cpp" line="1154"/>
+        <source>Ctrl+F</source>
+        <translation>Ctrl+F</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="100"/>
+        <location filename="../MainWindow.cpp" line="1159"/>
+        <source>Ctrl+R</source>
+        <translation>Ctrl+R</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="211"/>
         <source>Server bind failed. Are you running any other instance of Maurina?</source>
         <translation>Fallo al iniciar servidor. ¿Se está ejecutando ya otra instancia de Maurina?</translation>
     </message>
     <message>
-        <location filename="../MainWindow.cpp" line="147"/>
+        <location filename="../MainWindow.cpp" line="273"/>
         <source>Listening at %1:%2</source>
         <translation>Escuchando en %1:%2</translation>
     </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="287"/>
+        <source>relays at %1:%2</source>
+        <translation>reenvía a %1:%2</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="292"/>
+        <source>Relay bind failed at port %1</source>
+        <translation>Fallo al iniciar el reenvío en el puerto %1</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="796"/>
+        <source>&quot;%1&quot; found in %2</source>
+        <translation>&quot;%1&quot; encontrado en %2</translation>
+    </message>
+    <message numerus="yes">
+        <location filename="../MainWindow.cpp" line="805"/>
+        <source>%n more watched message(s)</source>
+        <translation>
+            <numerusform>%n mensaje vigilado más</numerusform>
+            <numerusform>%n mensajes vigilados más</numerusform>
+        </translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="825"/>
+        <source>Maurina watchlist</source>
+        <translation>Vigilancia de Maurina</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="835"/>
+        <source>(%1 watched messages)</source>
+        <translation>(%1 mensajes vigilados)</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="850"/>
+        <source>%1: %2</source>
+        <translation>%1: %2</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="863"/>
+        <source>(%1 messages shed)</source>
+        <translation>(%1 mensajes descartados)</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="864"/>
+        <source>Normal lane: %1
+Bulk lane: %2</source>
+        <translation>Carril normal: %1
+Carril masivo: %2</translation>
+    </message>
+    <message>
+        <location filename="../MainWindow.cpp" line="1372"/>
+        <source>Messages from that moment are no longer in the log</source>
+        <translation>Los mensajes de ese momento ya no están en el log</translation>
+    </message>
+</context>
+<context>
+    <name>TimelineWidget</name>
+    <message>
+        <location filename="../TimelineWidget.cpp" line="143"/>
+        <source>%1 min</source>
+        <translation>%1 min</translation>
+    </message>
+    <message>
+        <location filename="../TimelineWidget.cpp" line="144"/>
+        <source>%1 h</source>
+        <translation>%1 h</translation>
+    </message>
+    <message>
+        <location filename="../TimelineWidget.cpp" line="148"/>
+        <source>%1 msg/s</source>
+        <translation>%1 msj/s</translation>
+    </message>
 </context>
 <context>
     <name>aboutWindow</name>
@@ -222,7 +366,7 @@ p, li { white-space: pre-wrap; }
 &lt;p align=&quot;center&quot; style=&quot; margin-top:0px; margin-bottom:0px; margin-left:0px; margin-right:0px; -qt-block-indent:0; text-indent:0px;&quot;&gt;&lt;span style=&quot; font-family:&apos;Ubuntu&apos;; font-size:10pt;&quot;&gt;This software is free as in free beer and free speech.&lt;/span&gt;&lt;/p&gt;
 &lt;p align=&quot;center&quot; style=&quot;-qt-paragraph-type:empty; margin-top:0px; margin-bottom:0px; margin-left:0px; margin-right:0px; -qt-block-indent:0; text-indent:0px; font-family:&apos;Ubuntu&apos;; font-size:10pt;&quot;&gt;&lt;br /&gt;&lt;/p&gt;
 &lt;p align=&quot;center&quot; style=&quot; margin-top:0px; margin-bottom:0px; margin-left:0px; margin-right:0px; -qt-block-indent:0; text-indent:0px;&quot;&gt;&lt;span style=&quot; font-family:&apos;Ubuntu&apos;; font-size:10pt;&quot;&gt;If you find this program useful please consider &lt;/span&gt;&lt;a href=&quot;http://www.maurina.org/donate&quot;&gt;&lt;span style=&quot; text-decoration: underline; color:#0000ff;&quot;&gt;making a donation&lt;/span&gt;&lt;/a&gt;&lt;span style=&quot; font-family:&apos;Ubuntu&apos;; font-size:10pt;&quot;&gt;.&lt;/span&gt;&lt;/p&gt;&lt;/td&gt;&lt;/tr&gt;&lt;/table&gt;&lt;/body&gt;&lt;/html&gt;</source>
-        <translation>&lt;!DOCTYPE HTML PUBLIC &quot;-//W3C//DTD HTML 4.0//EN&quot; &quot;http://www.w3.org/TR/REC-html40/strict.dtd&quot;&gt;
+        <translation type="vanished">&lt;!DOCTYPE HTML PUBLIC &quot;-//W3C//DTD HTML 4.0//EN&quot; &quot;http://www.w3.org/TR/REC-html40/strict.dtd&quot;&gt;
 &lt;html&gt;&lt;head&gt;&lt;meta name=&quot;qrichtext&quot; content=&quot;1&quot; /&gt;&lt;style type=&quot;text/css&quot;&gt;
 p, li { white-space: pre-wrap; }
 &lt;/style&gt;&lt;/head&gt;&lt;body style=&quot; font-family:&apos;Sans Serif&apos;; font-size:9pt; font-weight:400; font-style:normal;&quot;&gt;
@@ -321,4 +465,117 @@ p, li { white-space: pre-wrap; }
         <translation>h6</translation>
     </message>
 </context>
+<context>
+    <name>historyWindow</name>
+    <message>
+        <location filename="../historyWindow.ui" line="14"/>
+        <source>History</source>
+        <translation>Historial</translation>
+    </message>
+    <message>
+        <location filename="../historyWindow.ui" line="26"/>
+        <source>Search messages</source>
+        <translation>Buscar mensajes</translation>
+    </message>
+    <message>
+        <location filename="../historyWindow.ui" line="33"/>
+        <source>&amp;Find next</source>
+        <translation>Buscar &amp;siguiente</translation>
+    </message>
+    <message>
+        <location filename="../historyWindow.ui" line="86"/>
+        <source>Close</source>
+        <translation>Cerrar</translation>
+    </message>
+    <message>
+        <location filename="../historyWindow.cpp" line="46"/>
+        <location filename="../historyWindow.cpp" line="66"/>
+        <location filename="../historyWindow.cpp" line="106"/>
+        <source>%1 messages</source>
+        <translation>%1 mensajes</translation>
+    </message>
+    <message>
+        <location filename="../historyWindow.cpp" line="85"/>
+        <source>Searching...</source>
+        <translation>Buscando...</translation>
+    </message>
+    <message>
+        <location filename="../historyWindow.cpp" line="115"/>
+        <source>Not found</source>
+        <translation>No encontrado</translation>
+    </message>
+</context>
+<context>
+    <name>profilerWindow</name>
+    <message>
+        <location filename="../profilerWindow.ui" line="14"/>
+        <source>Profiler</source>
+        <translation>Perfilador</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.ui" line="107"/>
+        <source>&amp;Reset</source>
+        <translation>&amp;Reiniciar</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.ui" line="117"/>
+        <source>Close</source>
+        <translation>Cerrar</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="24"/>
+        <source>Span</source>
+        <translation>Span</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="25"/>
+        <source>Count</source>
+        <translation>Cuenta</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="25"/>
+        <source>Total (ms)</source>
+        <translation>Total (ms)</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="25"/>
+        <source>Mean</source>
+        <translation>Media</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="26"/>
+        <source>Min</source>
+        <translation>Mín</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="26"/>
+        <source>p50</source>
+        <translation>p50</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="26"/>
+        <source>p95</source>
+        <translation>p95</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="27"/>
+        <source>p99</source>
+        <translation>p99</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="27"/>
+        <source>Max</source>
+        <translation>Máx</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="66"/>
+        <source>%1 spans, %2 names</source>
+        <translation>%1 spans, %2 nombres</translation>
+    </message>
+    <message>
+        <location filename="../profilerWindow.cpp" line="115"/>
+        <source>%1  %2  %3 ms</source>
+        <translation>%1  %2  %3 ms</translation>
+    </message>
+</context>
 </TS>
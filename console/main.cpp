@@ -1,8 +1,92 @@
 #include "MainWindow.h"
+#include "RelayForwarder.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QHostInfo>
+
+/**
+* Splits a host:port value. Returns false if the port is missing or invalid.
+*/
+static bool splitAddress(const QString &value, QString *host, quint16 *port)
+{
+    int colon = value.lastIndexOf(':');
+    if (colon <= 0)
+        return false;
+
+    bool ok;
+    int number = value.mid(colon + 1).toInt(&ok);
+    if (!ok || number <= 0 || number > 65535)
+        return false;
+
+    *host = value.left(colon);
+    *port = (quint16) number;
+    return true;
+}
+
+/**
+* Headless relay mode: forwards the datagrams received on this node to a
+* central console
+*/
+static int runRelay(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("maurina");
+    QCoreApplication::setApplicationVersion(VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Maurina relay. Forwards the datagrams "
+                                     "sent on this node to a central "
+                                     "console.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption relay("relay", "Run as a relay, without window.");
+    QCommandLineOption listen("listen", "Address datagrams are sent to on "
+                              "this node. Defaults to 127.0.0.1:1947.",
+                              "ip:port", "127.0.0.1:1947");
+    QCommandLineOption forward("forward", "Central console, as set by its "
+                               "relayIp and relayPort config values.",
+                               "host:port");
+    QCommandLineOption node("node", "Name shown as the message source. "
+                            "Defaults to the host name.", "name",
+                            QHostInfo::localHostName());
+    parser.addOption(relay);
+    parser.addOption(listen);
+    parser.addOption(forward);
+    parser.addOption(node);
+    parser.process(a);
+
+    QString listenHost, forwardHost;
+    quint16 listenPort, forwardPort;
+    if (!splitAddress(parser.value(listen), &listenHost, &listenPort))
+    {
+        qCritical("Invalid --listen address, expected ip:port");
+        return 1;
+    }
+    if (!splitAddress(parser.value(forward), &forwardHost, &forwardPort))
+    {
+        qCritical("Missing or invalid --forward address, expected host:port");
+        return 1;
+    }
+
+    RelayForwarder forwarder;
+    if (!forwarder.start(QHostAddress(listenHost), listenPort,
+                         forwardHost, forwardPort, parser.value(node)))
+        return 1;
+
+    return a.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    // Relay mode has no window, so it's checked before creating the GUI
+    // application
+    for (int x = 1; x < argc; ++x)
+    {
+        if (qstrcmp(argv[x], "--relay") == 0)
+            return runRelay(argc, argv);
+    }
+
     QApplication a(argc, argv);
 
     // Get system language and load translations
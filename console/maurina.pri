@@ -0,0 +1,48 @@
+# Console sources shared by the application and the benchmarks
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/MainWindow.cpp \
+    $$PWD/aboutWindow.cpp \
+    $$PWD/configWindow.cpp \
+    $$PWD/RateHistory.cpp \
+    $$PWD/TimelineWidget.cpp \
+    $$PWD/DatagramDecoder.cpp \
+    $$PWD/MessageLanes.cpp \
+    $$PWD/HistoryStore.cpp \
+    $$PWD/HistoryModel.cpp \
+    $$PWD/historyWindow.cpp \
+    $$PWD/SpanAggregator.cpp \
+    $$PWD/FlameWidget.cpp \
+    $$PWD/profilerWindow.cpp \
+    $$PWD/RelayBatch.cpp \
+    $$PWD/RelayForwarder.cpp \
+    $$PWD/RelayServer.cpp \
+    $$PWD/KeywordMatcher.cpp
+
+HEADERS  += $$PWD/MainWindow.h \
+    $$PWD/aboutWindow.h \
+    $$PWD/configWindow.h \
+    $$PWD/RateHistory.h \
+    $$PWD/TimelineWidget.h \
+    $$PWD/DatagramDecoder.h \
+    $$PWD/MessageLanes.h \
+    $$PWD/HistoryStore.h \
+    $$PWD/HistoryModel.h \
+    $$PWD/historyWindow.h \
+    $$PWD/SpanAggregator.h \
+    $$PWD/FlameWidget.h \
+    $$PWD/profilerWindow.h \
+    $$PWD/RelayBatch.h \
+    $$PWD/RelayForwarder.h \
+    $$PWD/RelayServer.h \
+    $$PWD/KeywordMatcher.h
+
+FORMS    += $$PWD/MainWindow.ui \
+    $$PWD/aboutWindow.ui \
+    $$PWD/configWindow.ui \
+    $$PWD/historyWindow.ui \
+    $$PWD/profilerWindow.ui
+
+RESOURCES += \
+    $$PWD/main.qrc
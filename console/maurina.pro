@@ -12,21 +12,9 @@ TARGET = maurina
 TEMPLATE = app
 
 
-SOURCES += main.cpp\
-        MainWindow.cpp \
-    aboutWindow.cpp \
-    configWindow.cpp
+SOURCES += main.cpp
 
-HEADERS  += MainWindow.h \
-    aboutWindow.h \
-    configWindow.h
-
-FORMS    += MainWindow.ui \
-    aboutWindow.ui \
-    configWindow.ui
-
-RESOURCES += \
-    main.qrc
+include(maurina.pri)
 
 TRANSLATIONS = languages/maurina_es.ts
 
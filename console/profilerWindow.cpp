@@ -0,0 +1,145 @@
+#include "profilerWindow.h"
+#include "ui_profilerWindow.h"
+
+#include <QHeaderView>
+#include <QDateTime>
+
+// Numeric cells so sorting by a column compares values, not text
+static QTableWidgetItem *numberItem(double value)
+{
+    QTableWidgetItem *item = new QTableWidgetItem();
+    item->setData(Qt::DisplayRole, qRound64(value * 1000) / 1000.0);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+profilerWindow::profilerWindow(SpanAggregator *spans, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::profilerWindow),
+    spans(spans),
+    shownSpans(0)
+{
+    ui->setupUi(this);
+
+    ui->uiStats->setHorizontalHeaderLabels(QStringList() << tr("Span")
+                            << tr("Count") << tr("Total (ms)") << tr("Mean")
+                            << tr("Min") << tr("p50") << tr("p95")
+                            << tr("p99") << tr("Max"));
+    ui->uiStats->verticalHeader()->hide();
+    ui->uiStats->horizontalHeader()->setSectionResizeMode(0,
+                                                    QHeaderView::Stretch);
+    ui->uiStats->sortByColumn(2, Qt::DescendingOrder);
+
+    // Statistics are refreshed while the window is open
+    this->refreshTimer = new QTimer(this);
+    this->refreshTimer->start(1000);
+
+    connect(ui->uiCloseButton,  SIGNAL(clicked()),
+            this,               SLOT(close()));
+    connect(ui->uiResetButton,  SIGNAL(clicked()),
+            this,               SLOT(slReset()));
+    connect(ui->uiRequests,     SIGNAL(itemSelectionChanged()),
+            this,               SLOT(slRequestChanged()));
+    connect(this->refreshTimer, SIGNAL(timeout()),
+            this,               SLOT(slRefresh()));
+
+    this->refresh();
+}
+
+profilerWindow::~profilerWindow()
+{
+    delete ui;
+}
+
+void profilerWindow::slRefresh()
+{
+    if (this->isVisible() && this->spans->received() != this->shownSpans)
+        this->refresh();
+}
+
+void profilerWindow::refresh()
+{
+    this->shownSpans = this->spans->received();
+    this->updateStats();
+    this->updateRequests();
+
+    ui->uiSummary->setText(tr("%1 spans, %2 names")
+                           .arg(this->shownSpans)
+                           .arg(this->spans->statsCount()));
+}
+
+void profilerWindow::updateStats()
+{
+    // Rows are refilled with sorting off so they don't move while filling
+    ui->uiStats->setSortingEnabled(false);
+    ui->uiStats->setRowCount(this->spans->statsCount());
+
+    for (int x = 0; x < this->spans->statsCount(); ++x)
+    {
+        const SpanStats &stats = this->spans->statsAt(x);
+        double mean = (stats.count > 0) ? stats.total / stats.count : 0;
+
+        ui->uiStats->setItem(x, 0, new QTableWidgetItem(stats.name));
+        ui->uiStats->setItem(x, 1, numberItem(stats.count));
+        ui->uiStats->setItem(x, 2, numberItem(stats.total));
+        ui->uiStats->setItem(x, 3, numberItem(mean));
+        ui->uiStats->setItem(x, 4, numberItem(stats.min));
+        ui->uiStats->setItem(x, 5, numberItem(stats.percentile(0.50)));
+        ui->uiStats->setItem(x, 6, numberItem(stats.percentile(0.95)));
+        ui->uiStats->setItem(x, 7, numberItem(stats.percentile(0.99)));
+        ui->uiStats->setItem(x, 8, numberItem(stats.max));
+    }
+
+    ui->uiStats->setSortingEnabled(true);
+}
+
+void profilerWindow::updateRequests()
+{
+    // Keep the selected request selected if it's still listed
+    QListWidgetItem *current = ui->uiRequests->currentItem();
+    quint64 selected = (current != NULL) ?
+                       current->data(Qt::UserRole).toULongLong() : 0;
+
+    QList<SpanRecord> requests =
+                            this->spans->recentRequests(PROFILER_REQUESTS);
+
+    ui->uiRequests->blockSignals(true);
+    ui->uiRequests->clear();
+    for (int x = 0; x < requests.count(); ++x)
+    {
+        const SpanRecord &request = requests.at(x);
+        QDateTime time = QDateTime::fromMSecsSinceEpoch(
+                                                (qint64) request.start);
+
+        QListWidgetItem *item = new QListWidgetItem(
+                    tr("%1  %2  %3 ms").arg(time.toString("HH:mm:ss.zzz"))
+                                        .arg(request.name)
+                                        .arg(request.duration, 0, 'f', 3));
+        item->setData(Qt::UserRole, request.sequence);
+        ui->uiRequests->addItem(item);
+
+        if (current != NULL && request.sequence == selected)
+            ui->uiRequests->setCurrentItem(item);
+    }
+    ui->uiRequests->blockSignals(false);
+}
+
+void profilerWindow::slRequestChanged()
+{
+    QListWidgetItem *item = ui->uiRequests->currentItem();
+    if (item == NULL)
+    {
+        ui->uiFlame->setSpans(QVector<FlameSpan>());
+        return;
+    }
+
+    quint64 request = item->data(Qt::UserRole).toULongLong();
+    ui->uiFlame->setSpans(this->spans->flame(request));
+}
+
+void profilerWindow::slReset()
+{
+    this->spans->clear();
+    ui->uiFlame->setSpans(QVector<FlameSpan>());
+    this->refresh();
+}
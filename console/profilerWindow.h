@@ -0,0 +1,42 @@
+#ifndef PROFILERWINDOW_H
+#define PROFILERWINDOW_H
+
+#include <QDialog>
+#include <QTimer>
+
+#include "SpanAggregator.h"
+
+// Requests listed for the flame view
+#define PROFILER_REQUESTS 200
+
+namespace Ui {
+class profilerWindow;
+}
+
+class profilerWindow : public QDialog
+{
+    Q_OBJECT
+
+private slots:
+    void slRefresh();
+    void slRequestChanged();
+    void slReset();
+
+public:
+    explicit profilerWindow(SpanAggregator *spans, QWidget *parent = 0);
+    ~profilerWindow();
+
+    void refresh();
+
+private:
+    Ui::profilerWindow *ui;
+
+    SpanAggregator *spans;
+    QTimer *refreshTimer;
+    quint64 shownSpans;
+
+    void updateStats();
+    void updateRequests();
+};
+
+#endif // PROFILERWINDOW_H
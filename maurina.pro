@@ -0,0 +1,14 @@
+#-------------------------------------------------
+#
+# Builds the console together with its benchmarks, so changes to the shared
+# sources in console/maurina.pri are always compiled by both.
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS = app \
+    benchmarks
+
+app.file = console/maurina.pro
+benchmarks.file = console/benchmarks/benchmarks.pro